@@ -0,0 +1,230 @@
+#!/bin/bash
+
+# Runs the whole pipeline (hamiltonian, eig with its observables, splice-eigenvecs and
+# transitions) for calculation directories made by populate.sh, going through a
+# persistent result cache.
+#
+# The cache key is a hash of the canonical values of every "parameters.inp" field
+# (printed with 17 significant digits, so distinct doubles never share a key), the
+# solver settings and the code version (the hash of the executables). A hit copies the
+# stored eigenvalues, selected eigenvectors and observables into the directory without
+# diagonalizing anything. Parallel workers may share a cache: each key is computed under
+# a lock and published with an atomic rename.
+#
+# The sweep itself is checkpointed: every finished directory is recorded in
+# ".cached-run.completed" and a run started with --resume skips them. The list is
+# shared by the runs started from the same directory, so only --reset empties it. eig
+# always runs with --resume, so a point that was interrupted in the middle of a
+# diagonalization continues from its last checkpoint.
+#
+# Points run concurrently. The cost of a point grows as size^3, where size =
+# 9(1+n_R)(1+n_ir) is the dimension of its basis, so the points are started largest
+# first and each one gets a thread budget for Eigen's parallel products (through
+# OMP_NUM_THREADS) in proportion to its share of the work still to start, capped by the
+# free cores and by MIN_ROWS_PER_THREAD. A point only starts if its estimated memory
+# (32 size^2 bytes) fits in what the running points left, so a sweep mixing a few
+# large points with many small ones keeps every core busy: the large points run
+# threaded while the small ones run side by side on the remaining cores. Cache hits
+# cost nothing and run last. The budgets only matter if eig was built with OpenMP or
+# Eigen's thread pool, e.g. make CXXFLAGS="-O2 -fopenmp".
+#
+# usage: cached-run.sh [--resume] [--reset] [calculation directory ...]
+#        (defaults to every directory in "calculations")
+#
+# Environment:
+#   CACHE_DIR   where the results are kept (default ~/.cache/3-sites-linear)
+#   EIG_FLAGS   observables computed by eig (default "--mean-phonons --entanglement")
+#   RESULTS_STORE  if set, every point is also appended to this store-results file
+#   CORES       cores shared by the running points (default: all of them)
+#   MEMORY_LIMIT  memory shared by the running points, in MiB (default: MemAvailable)
+#   MIN_ROWS_PER_THREAD  a point of size n gets at most n / MIN_ROWS_PER_THREAD threads
+#               (default 500, smaller matrices do not gain from more threads)
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+EIG="$HERE/../eig"
+CACHE_DIR=${CACHE_DIR:-$HOME/.cache/3-sites-linear}
+EIG_FLAGS=${EIG_FLAGS:---mean-phonons --entanglement}
+CORES=${CORES:-`nproc`}
+MEMORY_LIMIT=${MEMORY_LIMIT:-`awk '/^MemAvailable:/ { print int($2 / 1024) }' /proc/meminfo`}
+MIN_ROWS_PER_THREAD=${MIN_ROWS_PER_THREAD:-500}
+RESULTS="eigenvalues.txt v*.txt mean_ir.txt mean_ram.txt stdd_ir.txt stdd_ram.txt \
+entanglement_spectrum.txt entanglement_entropy.txt \
+dipole_transitions.txt ir_transitions.txt raman_transitions.txt"
+
+if [ -n "$RESULTS_STORE" ]; then
+    RESULTS_STORE=$(cd "$(dirname "$RESULTS_STORE")" && pwd)/$(basename "$RESULTS_STORE")
+fi
+
+for TOOL in "$EIG" "$HERE/hamiltonian" "$HERE/splice-eigenvecs" "$HERE/transitions" "$HERE/store-results"; do
+    if [ ! -x "$TOOL" ]; then
+	printf "I couldn't find %s, please run \"make\" first.\n" "$TOOL"
+	exit 1
+    fi
+done
+
+mkdir -p "$CACHE_DIR"
+VERSION=`cat "$EIG" "$HERE/hamiltonian" "$HERE/splice-eigenvecs" "$HERE/transitions" | sha256sum | cut -d ' ' -f 1`
+
+# Prints the cache key of the calculation in the current directory
+cache_key () {
+    local COUNT=0
+    local VALUE
+    {
+	while IFS=, read VALUE REST; do
+	    if (( COUNT < 10 )); then
+		printf "%.17g\n" "$VALUE"
+	    else
+		printf "%d\n" "$VALUE"
+	    fi
+	    ((COUNT += 1))
+	done < parameters.inp
+	printf "%s\n%s\n" "$EIG_FLAGS" "$VERSION"
+    } | sha256sum | cut -d ' ' -f 1
+}
+
+# Prints the size of the basis of the point in the directory $1, 9(1+n_R)(1+n_ir)
+point_size () {
+    local NIR NRAM
+    NIR=`sed -n '11s/,.*//p' "$1/parameters.inp"`
+    NRAM=`sed -n '12s/,.*//p' "$1/parameters.inp"`
+    echo $(( 9 * (1 + NIR) * (1 + NRAM) ))
+}
+
+# Runs the pipeline in the current directory
+compute () {
+    { [ -f hamiltonian.txt.checkpoint ] || "$HERE/hamiltonian" > /dev/null; } &&
+    "$EIG" --resume $EIG_FLAGS hamiltonian.txt > /dev/null &&
+    "$HERE/splice-eigenvecs" > /dev/null &&
+    "$HERE/transitions" > /dev/null &&
+    rm -f hamiltonian.txt eigenvectors.txt
+}
+
+# Copies the results of the current directory into the cache entry $1. The results a
+# run did not produce are skipped, but if any copy fails (e.g. the disk is full) nothing
+# is published and it returns 1.
+publish () {
+    local TMP FILE
+    TMP=`mktemp -d "$CACHE_DIR/.tmp.XXXXXX"` || return 1
+    for FILE in $RESULTS parameters.inp; do
+	if [ -e "$FILE" ] && ! cp -p "$FILE" "$TMP"; then
+	    rm -rf "$TMP"
+	    return 1
+	fi
+    done
+    mv -T "$TMP" "$CACHE_DIR/$1" 2> /dev/null || { rm -rf "$TMP"; return 1; }
+}
+
+# Records the directory $1 as completed. The list is rewritten under a lock and
+# replaced with an atomic rename.
+mark_completed () {
+    (
+	flock 8
+	grep -qxF "$1" "$COMPLETED" 2> /dev/null && exit 0
+	{ cat "$COMPLETED" 2> /dev/null; printf "%s\n" "$1"; } > "$COMPLETED.tmp.$$" &&
+	mv "$COMPLETED.tmp.$$" "$COMPLETED"
+    ) 8> "$COMPLETED.lock"
+}
+
+COMPLETED="$PWD/.cached-run.completed"
+RESUME=0
+while [ "$1" == "--resume" ] || [ "$1" == "--reset" ]; do
+    if [ "$1" == "--resume" ]; then
+	RESUME=1
+    else
+	( flock 8; rm -f "$COMPLETED" ) 8> "$COMPLETED.lock"
+    fi
+    shift
+done
+
+if [ $# -eq 0 ]; then
+    set -- calculations/c*
+fi
+
+# Runs the point in the directory $1 with $2 threads and records it as completed
+run_point () {
+    (
+	cd "$1" || exit 1
+	export OMP_NUM_THREADS=$2
+	KEY=`cache_key`
+	exec 9> "$CACHE_DIR/$KEY.lock"
+	flock 9
+	if [ -d "$CACHE_DIR/$KEY" ]; then
+	    printf "%s: found in the cache.\n" "$1"
+	    find "$CACHE_DIR/$KEY" -type f ! -name parameters.inp -exec cp -p {} . \;
+	elif compute; then
+	    if publish "$KEY"; then
+		printf "%s: computed on %d threads and saved in the cache.\n" "$1" "$2"
+	    else
+		printf "%s: computed on %d threads, but I couldn't save it in the cache.\n" "$1" "$2"
+	    fi
+	else
+	    printf "%s: the calculation failed.\n" "$1"
+	    exit 1
+	fi
+	if [ -n "$RESULTS_STORE" ]; then
+	    "$HERE/store-results" append "$RESULTS_STORE" .
+	fi
+    ) && mark_completed "$1"
+}
+
+# Queue the points largest first, cache hits (size 0) last
+QUEUE=()
+while read SIZE DIR; do
+    QUEUE+=("$SIZE $DIR")
+done < <(
+    for DIR in "$@"; do
+	if (( RESUME )) && grep -qxF "$DIR" "$COMPLETED" 2> /dev/null; then
+	    printf "%s: already completed.\n" "$DIR" >&2
+	    continue
+	fi
+	if [ ! -f "$DIR/parameters.inp" ]; then
+	    printf "There's no \"parameters.inp\" in %s, I will skip it.\n" "$DIR" >&2
+	    continue
+	fi
+	if [ -d "$CACHE_DIR/`cd "$DIR" && cache_key`" ]; then
+	    printf "0 %s\n" "$DIR"
+	else
+	    printf "%d %s\n" "`point_size "$DIR"`" "$DIR"
+	fi
+    done | sort -k 1,1nr
+)
+
+REMAINING=0
+for POINT in "${QUEUE[@]}"; do
+    SIZE=${POINT%% *}
+    (( REMAINING += SIZE * SIZE * SIZE ))
+done
+
+FREE_CORES=$CORES
+FREE_MEMORY=$MEMORY_LIMIT
+declare -A JOB_CORES JOB_MEMORY
+NEXT=0
+while (( NEXT < ${#QUEUE[@]} || ${#JOB_CORES[@]} > 0 )); do
+    if (( NEXT < ${#QUEUE[@]} && FREE_CORES > 0 )); then
+	SIZE=${QUEUE[NEXT]%% *}
+	DIR=${QUEUE[NEXT]#* }
+	COST=$(( SIZE * SIZE * SIZE ))
+	MEMORY=$(( 32 * SIZE * SIZE / 1048576 + 16 ))
+	# A point larger than the limit still runs, alone
+	if (( MEMORY <= FREE_MEMORY || ${#JOB_CORES[@]} == 0 )); then
+	    THREADS=$(( REMAINING > 0 ? (2 * CORES * COST + REMAINING) / (2 * REMAINING) : 1 ))
+	    (( THREADS > SIZE / MIN_ROWS_PER_THREAD )) && THREADS=$(( SIZE / MIN_ROWS_PER_THREAD ))
+	    (( THREADS > FREE_CORES )) && THREADS=$FREE_CORES
+	    (( THREADS < 1 )) && THREADS=1
+	    run_point "$DIR" $THREADS &
+	    JOB_CORES[$!]=$THREADS
+	    JOB_MEMORY[$!]=$MEMORY
+	    (( FREE_CORES -= THREADS, FREE_MEMORY -= MEMORY, REMAINING -= COST, NEXT += 1 ))
+	    continue
+	fi
+    fi
+    # Wait for a point to finish and give its cores and memory back
+    wait -n
+    for PID in "${!JOB_CORES[@]}"; do
+	if ! kill -0 $PID 2> /dev/null; then
+	    wait $PID
+	    (( FREE_CORES += JOB_CORES[$PID], FREE_MEMORY += JOB_MEMORY[$PID] ))
+	    unset "JOB_CORES[$PID]" "JOB_MEMORY[$PID]"
+	fi
+    done
+done
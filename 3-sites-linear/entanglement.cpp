@@ -0,0 +1,84 @@
+/*
+  Computes the electron-phonon entanglement of the eigenstates: the spectrum of the
+  reduced electronic density matrix and the entanglement entropy. Reads "parameters.inp"
+  and "eigenvectors.txt" and writes "entanglement_spectrum.txt" (one line per state with
+  the 9 eigenvalues in decreasing order) and "entanglement_entropy.txt".
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <Eigen/Dense>
+#include "model.h"
+#include "observables.h"
+
+using namespace std;
+using namespace Eigen;
+
+IOFormat LongPrinting(20);
+
+void save_matrix(string, MatrixXd);
+
+const char *usage = "usage: entanglement [k]\n       where 'k' is the number of eigenstates to use (default all).";
+
+int main (int argc, char *argv[]) {
+  model_parameters p;
+  int size, states;
+
+  if (argc > 2) {
+    cout << usage << endl;
+    return 1;
+  }
+
+  if (!read_parameters("parameters.inp", p)) {
+    cout << "Input file \"parameters.inp\" not found. I can't proceed any further. " << endl;
+    return 1;
+  }
+
+  size = basis_size(p);
+  states = size;
+  if (argc == 2 && !parse_states(argv[1], size, states)) {
+    cout << "'k' must be a number of eigenstates between 1 and " << size << ".\n" << usage << endl;
+    return 1;
+  }
+
+  MatrixXd eigenvectors;
+  if (read_columns("eigenvectors.txt", size, states, eigenvectors)) {
+    cout << "Using the first " << eigenvectors.cols() << " eigenvectors of size " << eigenvectors.rows() << endl;
+  }
+  else {
+    cout << "eigenvectors.txt not found. " << endl;
+    return 1;
+  }
+
+  MatrixXd spectrum;
+  VectorXd entropy;
+  cout << "Calculating entanglement spectra. ";
+  entanglement_spectra(eigenvectors, spectrum, entropy);
+  cout << "Done. " << endl;
+
+  cout << "Saving entanglement spectra at \"entanglement_spectrum.txt\"... ";
+  save_matrix("entanglement_spectrum.txt", spectrum.transpose());
+  cout << "Done. " << endl;
+
+  cout << "Saving entanglement entropies at \"entanglement_entropy.txt\"... ";
+  save_matrix("entanglement_entropy.txt", entropy);
+  cout << "Done. " << endl;
+
+  return 0;
+}
+
+void save_matrix(string filename, MatrixXd m) {
+  ofstream outfile;
+  outfile.open(filename.c_str(), ios::out);
+  if(outfile.is_open()) {
+    outfile << m.format(LongPrinting);
+    outfile << endl;
+    outfile.close();
+  }
+  else {
+    cout << "Unable to create file." << endl;
+  }
+  return;
+}
@@ -23,11 +23,13 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
 #include <fstream>
 #include <cmath>
 #include <Eigen/Dense>
-
+#include "profile.h"
+#include "model.h"
 
 using namespace std;
 using namespace Eigen;
@@ -37,183 +39,50 @@ IOFormat LongPrinting(20);
 void save_hamiltonian(MatrixXd);
 void save_parameters(double*, double, double, double, double, double, double, double, int, int);
 
-// Assing a unique label according to the position of electron 1 (e1), electron 2 (e2),
-// the number if infrared and Raman phonons (ir and ram) and the total number of infrared
-// phonons (n_ir)
-int state_label (int e1, int e2, int ir, int ram, int n_ir)
-{
-  return e1 + (3 * (e2 -1)) + (9 * ir) + (9 * ram * (n_ir + 1)) - 1;
-}
+// Sums the contributions of hamiltonian_elements into a dense matrix
+struct dense_adder {
+  MatrixXd &h;
+  dense_adder(MatrixXd &m) : h(m) {}
+  void operator() (int row, int col, double value) { h(row, col) += value; }
+};
 
 
 int main (int argc, char *argv[]) {
-  int ir_phonons, raman_phonons, size;
-  double band_energy[3];
-  double nn_hopping, on_site_repulsion, ir_energy, raman_energy, raman_shift;
-  double e_ir_coupling, e_ram_coupling;
-
-  int e1, e2, ir, ram, row, col, n;  // just counters
-  double energy;  // useful variable to fill in the hamiltonian elements
-
-  ifstream inputfile;
-  string line;
-  inputfile.open("parameters.inp");
-  if (inputfile.is_open()) {
-    // TODO: Assert that the values make sense
-    getline(inputfile, line, ',');
-    band_energy[0] = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    band_energy[1] = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    band_energy[2] = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    nn_hopping = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    on_site_repulsion = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    ir_energy = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    e_ir_coupling  = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    raman_energy = atof(line.c_str());
-    getline(inputfile, line);
+  model_parameters p;
+  int size;
 
-    getline(inputfile, line, ',');
-    e_ram_coupling = atof(line.c_str());
-    getline(inputfile, line);
+  if (argc > 1 && strcmp(argv[1], "--profile") == 0)
+    profile::enable("hamiltonian");
 
-    getline(inputfile, line, ',');
-    raman_shift = atof(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    ir_phonons = atoi(line.c_str());
-    getline(inputfile, line);
-
-    getline(inputfile, line, ',');
-    raman_phonons = atoi(line.c_str());
-    getline(inputfile, line);
-
-    inputfile.close();
-  }
-  else {
+  profile::phase read_timer("read");
+  if (!read_parameters("parameters.inp", p)) {
     cout << "Input file \"parameters.inp\" not found. I will create a template for you. " << endl;
     double temp[3] = {0, 0, 0};
     save_parameters(temp, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0);
     return 0;
   }
+  read_timer.stop();
 
-  size = 9 * (1 + raman_phonons) * (1 + ir_phonons);
+  size = basis_size(p);
   cout << "The size of the hamiltonian is: " << size << "x" << size << endl;
 
+  profile::phase build_timer("build");
   MatrixXd h = MatrixXd::Zero(size, size);
 
 
   // building the hamiltonian
-  for (e1 = 1; e1 <= 3; e1++) {
-    for (e2 = 1; e2 <= 3; e2++) {
-      for (ir = 0; ir <= ir_phonons; ir++) {
-	for (ram = 0; ram <= raman_phonons; ram++) {
-
-	  // band energies
-	  row = state_label(e1, e2, ir, ram, ir_phonons);
-	  col = state_label(e1, e2, ir, ram, ir_phonons);
-	  energy = band_energy[e1 - 1] + band_energy[e2 - 1];
-	  h(row,col) += energy;
+  dense_adder add(h);
+  hamiltonian_elements(p, add);
 
-	  // on-site Coulomb repulsion
-	  if (e1 == e2) {
-	    row = state_label(e1, e1, ir, ram, ir_phonons);
-	    col = state_label(e1, e1, ir, ram, ir_phonons);
-	    h(row, col) += on_site_repulsion;
-	  }
-
-	  // nearest-neighbor hopping
-	  if (e1 != 3) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1 + 1, e2, ir, ram, ir_phonons);
-	    h(row, col) += nn_hopping;
-	  }
-	  if (e1 != 1) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1 - 1, e2, ir, ram, ir_phonons);
-	    h(row, col) += nn_hopping;
-	  }
-	  if (e2 != 3) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1, e2 + 1, ir, ram, ir_phonons);
-	    h(row, col) += nn_hopping;
-	  }
-	  if (e2 != 1) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1, e2 - 1, ir, ram, ir_phonons);
-	    h(row, col) += nn_hopping;
-	  }
-	  
-	  // infrared phonons energy
-	  row = state_label(e1, e2, ir, ram, ir_phonons);
-	  col = state_label(e1, e2, ir, ram, ir_phonons);
-	  energy = ir * ir_energy;
-	  h(row, col) += energy;
-
-	  // raman phonons energy
-	  row = state_label(e1, e2, ir, ram, ir_phonons);
-	  col = state_label(e1, e2, ir, ram, ir_phonons);
-	  energy = ram * raman_energy;
-	  h(row, col) += energy;
-
-	  // electron - infrared phonons interaction
-	  n = e1 + e2 - 4;
-	  if (ir != ir_phonons) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1, e2, ir + 1, ram, ir_phonons);
-	    energy = n * e_ir_coupling * sqrt(ir + 1);
-	    h(row, col) += energy;
-	  }
-	  if (ir != 0) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1, e2, ir - 1, ram, ir_phonons);
-	    energy = n * e_ir_coupling * sqrt(ir);
-	    h(row, col) += energy;
-	  }
-	  
-	  // electron - Raman phonons interaction
-	  n = abs(e1 - 2) + abs(e2 - 2) - raman_shift;
-	  if (ram != raman_phonons) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1, e2, ir, ram + 1, ir_phonons);
-	    energy = n * e_ram_coupling * sqrt(ram + 1);
-	    h(row, col) += energy;
-	  }
-	  if (ram != 0) {
-	    row = state_label(e1, e2, ir, ram, ir_phonons);
-	    col = state_label(e1, e2, ir, ram - 1, ir_phonons);
-	    energy = n * e_ram_coupling * sqrt(ram);
-	    h(row, col) += energy;
-	  }
-	}
-      }
-    }
-  }
+  build_timer.stop();
 
   cout << "Saving the hamiltonian matrix at \"hamiltonian.txt\"... ";
+  profile::phase write_timer("write");
   save_hamiltonian(h);
+  write_timer.stop();
   cout << "Done." << endl;
 
+  profile::report();
   return 0;
 }
 
@@ -1,10 +1,12 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
 #include <fstream>
 #include <cmath>
 #include <sstream>
 #include <Eigen/Dense>
+#include "profile.h"
 
 using namespace std;
 using namespace Eigen;
@@ -27,8 +29,12 @@ int main (int argc, char *argv[]) {
 
   int e1, e2, ir, ram, row, col, n;  // just counters
 
+  if (argc > 1 && strcmp(argv[1], "--profile") == 0)
+    profile::enable("mean-phonons");
+
   ifstream inputfile;
   string line, val;
+  profile::phase read_timer("read");
   // Reading calculation parameters
   inputfile.open("parameters.inp");
   if (inputfile.is_open()) {
@@ -110,6 +116,7 @@ int main (int argc, char *argv[]) {
     cout << "eigenvectors.txt not found. " << endl;
     return 1;
   }
+  read_timer.stop();
 
   VectorXd mean_ir = VectorXd::Zero(size);
   VectorXd mean_ram = VectorXd::Zero(size);
@@ -117,6 +124,7 @@ int main (int argc, char *argv[]) {
   VectorXd stdd_ram = VectorXd::Zero(size);
 
   cout << "Calculating mean phonons and standard deviations. ";
+  profile::phase observables_timer("observables");
   // Calculate the mean phonons
   for (n = 0; n < size; n++) {
     float sqr_ir = 0;
@@ -136,8 +144,10 @@ int main (int argc, char *argv[]) {
     stdd_ir(n) = sqrt(sqr_ir - pow(mean_ir(n), 2));
     stdd_ram(n) = sqrt(sqr_ram - pow(mean_ram(n), 2));
   }
+  observables_timer.stop();
   cout << "Done. " << endl;
   
+  profile::phase write_timer("write");
   cout << "Saving mean infrared phonons at \"mean_ir.txt\"... ";
   save_vector("mean_ir.txt", mean_ir);
   cout << "Done. " << endl;
@@ -153,7 +163,9 @@ int main (int argc, char *argv[]) {
   cout << "Saving standard deviation for the mean raman phonons at \"stdd_ram.txt\"... ";
   save_vector("stdd_ram.txt", stdd_ram);
   cout << "Done. " << endl;
-	    
+  write_timer.stop();
+
+  profile::report();
   return 0;
 }
 
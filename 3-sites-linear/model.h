@@ -0,0 +1,163 @@
+/*
+  Pieces shared by the tools of the 3-sites-linear model: the parameters read from
+  "parameters.inp", the labelling of the basis states, the elements of the hamiltonian
+  and a reader for the matrices written by "eig".
+
+  See hamiltonian.cpp for a description of the model.
+ */
+
+#ifndef THREE_SITES_LINEAR_MODEL_H
+#define THREE_SITES_LINEAR_MODEL_H
+
+#include <stdlib.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <Eigen/Dense>
+
+struct model_parameters {
+  double band_energy[3];
+  double nn_hopping, on_site_repulsion, ir_energy, raman_energy, raman_shift;
+  double e_ir_coupling, e_ram_coupling;
+  int ir_phonons, raman_phonons;
+};
+
+// Assing a unique label according to the position of electron 1 (e1), electron 2 (e2),
+// the number if infrared and Raman phonons (ir and ram) and the total number of infrared
+// phonons (n_ir)
+inline int state_label (int e1, int e2, int ir, int ram, int n_ir)
+{
+  return e1 + (3 * (e2 -1)) + (9 * ir) + (9 * ram * (n_ir + 1)) - 1;
+}
+
+// The inverse of state_label: recover e1, e2, ir and ram from a label
+inline void state_from_label (int label, int n_ir, int &e1, int &e2, int &ir, int &ram)
+{
+  e1 = label % 3 + 1;
+  e2 = (label / 3) % 3 + 1;
+  ir = (label / 9) % (n_ir + 1);
+  ram = label / (9 * (n_ir + 1));
+}
+
+inline int basis_size (const model_parameters &p)
+{
+  return 9 * (1 + p.raman_phonons) * (1 + p.ir_phonons);
+}
+
+// Reads the number of eigenstates given on the command line into "states". Returns
+// false unless "text" is a whole number between 1 and the basis size "size".
+inline bool parse_states (const char *text, int size, int &states)
+{
+  char *end;
+  long value = strtol(text, &end, 10);
+  if (end == text || *end != '\0' || value < 1 || value > size)
+    return false;
+  states = (int) value;
+  return true;
+}
+
+// Calls add(row, col, value) for every contribution to the hamiltonian. A matrix element
+// may receive several contributions (the diagonal does), which have to be summed up.
+template<typename Adder>
+void hamiltonian_elements (const model_parameters &p, Adder &add)
+{
+  const int n_ir = p.ir_phonons;
+  int row, n;
+
+  for (int e1 = 1; e1 <= 3; e1++) {
+    for (int e2 = 1; e2 <= 3; e2++) {
+      for (int ir = 0; ir <= p.ir_phonons; ir++) {
+	for (int ram = 0; ram <= p.raman_phonons; ram++) {
+	  row = state_label(e1, e2, ir, ram, n_ir);
+
+	  // band energies
+	  add(row, row, p.band_energy[e1 - 1] + p.band_energy[e2 - 1]);
+
+	  // on-site Coulomb repulsion
+	  if (e1 == e2)
+	    add(row, row, p.on_site_repulsion);
+
+	  // nearest-neighbor hopping
+	  if (e1 != 3)
+	    add(row, state_label(e1 + 1, e2, ir, ram, n_ir), p.nn_hopping);
+	  if (e1 != 1)
+	    add(row, state_label(e1 - 1, e2, ir, ram, n_ir), p.nn_hopping);
+	  if (e2 != 3)
+	    add(row, state_label(e1, e2 + 1, ir, ram, n_ir), p.nn_hopping);
+	  if (e2 != 1)
+	    add(row, state_label(e1, e2 - 1, ir, ram, n_ir), p.nn_hopping);
+
+	  // infrared and Raman phonons energy
+	  add(row, row, ir * p.ir_energy);
+	  add(row, row, ram * p.raman_energy);
+
+	  // electron - infrared phonons interaction
+	  n = e1 + e2 - 4;
+	  if (ir != p.ir_phonons)
+	    add(row, state_label(e1, e2, ir + 1, ram, n_ir), n * p.e_ir_coupling * std::sqrt(ir + 1.0));
+	  if (ir != 0)
+	    add(row, state_label(e1, e2, ir - 1, ram, n_ir), n * p.e_ir_coupling * std::sqrt((double) ir));
+
+	  // electron - Raman phonons interaction
+	  n = abs(e1 - 2) + abs(e2 - 2) - p.raman_shift;
+	  if (ram != p.raman_phonons)
+	    add(row, state_label(e1, e2, ir, ram + 1, n_ir), n * p.e_ram_coupling * std::sqrt(ram + 1.0));
+	  if (ram != 0)
+	    add(row, state_label(e1, e2, ir, ram - 1, n_ir), n * p.e_ram_coupling * std::sqrt((double) ram));
+	}
+      }
+    }
+  }
+}
+
+// Reads "filename" in the format written by populate.sh. Returns false if the file
+// could not be opened.
+inline bool read_parameters (const char *filename, model_parameters &p)
+{
+  std::ifstream inputfile(filename);
+  std::string line;
+  if (!inputfile.is_open())
+    return false;
+
+  // TODO: Assert that the values make sense
+  double *reals[10] = {&p.band_energy[0], &p.band_energy[1], &p.band_energy[2],
+		       &p.nn_hopping, &p.on_site_repulsion, &p.ir_energy,
+		       &p.e_ir_coupling, &p.raman_energy, &p.e_ram_coupling, &p.raman_shift};
+  for (int i = 0; i < 10; i++) {
+    getline(inputfile, line, ',');
+    *reals[i] = atof(line.c_str());
+    getline(inputfile, line);
+  }
+
+  getline(inputfile, line, ',');
+  p.ir_phonons = atoi(line.c_str());
+  getline(inputfile, line);
+
+  getline(inputfile, line, ',');
+  p.raman_phonons = atoi(line.c_str());
+  getline(inputfile, line);
+
+  return true;
+}
+
+// Reads the first "cols" columns of a size x size matrix written by "eig" (one row
+// per line). Returns false if the file could not be opened.
+inline bool read_columns (const char *filename, int size, int cols, Eigen::MatrixXd &m)
+{
+  std::ifstream inputfile(filename);
+  std::string line;
+  if (!inputfile.is_open())
+    return false;
+
+  m.resize(size, cols);
+  for (int row = 0; row < size; row++) {
+    getline(inputfile, line);
+    std::stringstream ss(line);
+    for (int col = 0; col < cols; col++)
+      ss >> m(row, col);
+  }
+  return true;
+}
+
+#endif // THREE_SITES_LINEAR_MODEL_H
@@ -0,0 +1,142 @@
+/*
+  Observables of the 3-sites-linear model, written as operators in the state_label
+  basis so they can be applied to many eigenvectors at once.
+
+  Transition matrix elements <i|O|j> between the k selected eigenvectors V are
+  computed as V^T (O V): one sparse (or diagonal) times dense product followed by
+  one dense matrix product, instead of k^2 scalar loops over the basis.
+ */
+
+#ifndef THREE_SITES_LINEAR_OBSERVABLES_H
+#define THREE_SITES_LINEAR_OBSERVABLES_H
+
+#include <cmath>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include "model.h"
+
+// Electronic dipole rho_3 - rho_1. It is diagonal in the state_label basis so only
+// the diagonal is returned.
+inline Eigen::VectorXd dipole_operator (const model_parameters &p)
+{
+  int size = basis_size(p);
+  int e1, e2, ir, ram;
+  Eigen::VectorXd d(size);
+  for (int label = 0; label < size; label++) {
+    state_from_label(label, p.ir_phonons, e1, e2, ir, ram);
+    d(label) = e1 + e2 - 4;
+  }
+  return d;
+}
+
+// Phonon displacement a + a^dagger for the infrared (ir_mode = true) or the Raman mode.
+inline Eigen::SparseMatrix<double> displacement_operator (const model_parameters &p, bool ir_mode)
+{
+  int size = basis_size(p);
+  int e1, e2, ir, ram, row, col, n;
+  std::vector<Eigen::Triplet<double> > elements;
+  elements.reserve(2 * size);
+
+  for (row = 0; row < size; row++) {
+    state_from_label(row, p.ir_phonons, e1, e2, ir, ram);
+    if (ir_mode && ir != p.ir_phonons) {
+      n = ir;
+      col = state_label(e1, e2, ir + 1, ram, p.ir_phonons);
+    }
+    else if (!ir_mode && ram != p.raman_phonons) {
+      n = ram;
+      col = state_label(e1, e2, ir, ram + 1, p.ir_phonons);
+    }
+    else
+      continue;
+    elements.push_back(Eigen::Triplet<double>(row, col, std::sqrt(n + 1.0)));
+    elements.push_back(Eigen::Triplet<double>(col, row, std::sqrt(n + 1.0)));
+  }
+
+  Eigen::SparseMatrix<double> op(size, size);
+  op.setFromTriplets(elements.begin(), elements.end());
+  return op;
+}
+
+// <i|O|j> for every pair of columns of v, with O diagonal
+inline Eigen::MatrixXd transition_elements (const Eigen::VectorXd &diagonal, const Eigen::MatrixXd &v)
+{
+  Eigen::MatrixXd ov = diagonal.asDiagonal() * v;
+  return v.transpose() * ov;
+}
+
+// <i|O|j> for every pair of columns of v, with O sparse
+inline Eigen::MatrixXd transition_elements (const Eigen::SparseMatrix<double> &op, const Eigen::MatrixXd &v)
+{
+  Eigen::MatrixXd ov = op * v;
+  return v.transpose() * ov;
+}
+
+// Phonon-number probability distribution P(n_ir, n_R) of every column of v. Column s
+// of the result is the histogram of state s stored with n_ir running fastest, that is
+// P(ir, ram) is at row ir + ram * (n_ir + 1).
+//
+// Each basis index is mapped once through state_from_label to its (ir, ram) bucket and
+// |psi|^2 is then accumulated bucket by bucket, in parallel over the states.
+inline Eigen::MatrixXd phonon_distributions (const model_parameters &p, const Eigen::Ref<const Eigen::MatrixXd> &v)
+{
+  int size = basis_size(p);
+  int buckets = (p.ir_phonons + 1) * (p.raman_phonons + 1);
+  int e1, e2, ir, ram;
+
+  std::vector<int> bucket(size);
+  for (int label = 0; label < size; label++) {
+    state_from_label(label, p.ir_phonons, e1, e2, ir, ram);
+    bucket[label] = ir + ram * (p.ir_phonons + 1);
+  }
+
+  Eigen::MatrixXd histogram = Eigen::MatrixXd::Zero(buckets, v.cols());
+  int states = v.cols();
+#pragma omp parallel for schedule(static)
+  for (int s = 0; s < states; s++) {
+    const double *psi = v.col(s).data();
+    double *h = histogram.col(s).data();
+    for (int label = 0; label < size; label++)
+      h[bucket[label]] += psi[label] * psi[label];
+  }
+  return histogram;
+}
+
+// Electron-phonon entanglement of every column of v. In the state_label ordering the
+// 9 electronic configurations run fastest, so each eigenvector is viewed in place (no
+// copy) as a 9 x (n_ir+1)(n_R+1) matrix M of amplitudes. The eigenvalues of the reduced
+// electronic density matrix M M^T are the squared singular values of M; they are
+// returned in decreasing order in the columns of "spectrum", and the entanglement
+// entropy -sum(l log l) in "entropy". The states are processed in parallel.
+inline void entanglement_spectra (const Eigen::Ref<const Eigen::MatrixXd> &v, Eigen::MatrixXd &spectrum, Eigen::VectorXd &entropy)
+{
+  typedef Eigen::Matrix<double, 9, Eigen::Dynamic> AmplitudeMatrix;
+  typedef Eigen::Matrix<double, 9, 9> DensityMatrix;
+  int phonon_states = v.rows() / 9;
+  int states = v.cols();
+
+  spectrum.resize(9, states);
+  entropy.resize(states);
+  // the products below run on several threads at once, so Eigen's static state (cache
+  // sizes, thread count) has to be initialized before the parallel region
+  Eigen::initParallel();
+#pragma omp parallel for schedule(dynamic)
+  for (int s = 0; s < states; s++) {
+    Eigen::Map<const AmplitudeMatrix> amplitudes(v.col(s).data(), 9, phonon_states);
+    DensityMatrix rho;
+    rho.noalias() = amplitudes * amplitudes.transpose();
+    Eigen::SelfAdjointEigenSolver<DensityMatrix> solver(rho, Eigen::EigenvaluesOnly);
+
+    double s_vn = 0;
+    for (int i = 0; i < 9; i++) {
+      double l = solver.eigenvalues()(8 - i);
+      spectrum(i, s) = l;
+      if (l > 0)
+	s_vn -= l * std::log(l);
+    }
+    entropy(s) = s_vn;
+  }
+}
+
+#endif // THREE_SITES_LINEAR_OBSERVABLES_H
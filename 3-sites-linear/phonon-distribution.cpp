@@ -0,0 +1,85 @@
+/*
+  Computes the phonon-number probability distribution P(n_ir, n_R) of the eigenstates.
+  Reads "parameters.inp" and "eigenvectors.txt" and writes "phonon_distribution.bin",
+  a binary table with the following layout (native byte order):
+
+    char[8]   "PHDIST01"
+    int32     number of infrared phonons n_ir
+    int32     number of raman phonons n_R
+    int32     number of states
+    float32   P(ir, ram) for each state, (n_ir+1)*(n_R+1) values per state with
+              ir running fastest
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <Eigen/Dense>
+#include "model.h"
+#include "observables.h"
+
+using namespace std;
+using namespace Eigen;
+
+bool save_distributions(string, const model_parameters&, const MatrixXd&);
+
+const char *usage = "usage: phonon-distribution [k]\n       where 'k' is the number of eigenstates to use (default all).";
+
+int main (int argc, char *argv[]) {
+  model_parameters p;
+  int size, states;
+
+  if (argc > 2) {
+    cout << usage << endl;
+    return 1;
+  }
+
+  if (!read_parameters("parameters.inp", p)) {
+    cout << "Input file \"parameters.inp\" not found. I can't proceed any further. " << endl;
+    return 1;
+  }
+
+  size = basis_size(p);
+  states = size;
+  if (argc == 2 && !parse_states(argv[1], size, states)) {
+    cout << "'k' must be a number of eigenstates between 1 and " << size << ".\n" << usage << endl;
+    return 1;
+  }
+
+  MatrixXd eigenvectors;
+  if (read_columns("eigenvectors.txt", size, states, eigenvectors)) {
+    cout << "Using the first " << eigenvectors.cols() << " eigenvectors of size " << eigenvectors.rows() << endl;
+  }
+  else {
+    cout << "eigenvectors.txt not found. " << endl;
+    return 1;
+  }
+
+  cout << "Calculating phonon distributions. ";
+  MatrixXd distributions = phonon_distributions(p, eigenvectors);
+  cout << "Done. " << endl;
+
+  cout << "Saving phonon distributions at \"phonon_distribution.bin\"... ";
+  if (save_distributions("phonon_distribution.bin", p, distributions))
+    cout << "Done. " << endl;
+  else
+    cout << "Unable to create file." << endl;
+
+  return 0;
+}
+
+bool save_distributions(string filename, const model_parameters &p, const MatrixXd &distributions) {
+  ofstream outfile(filename.c_str(), ios::out | ios::binary);
+  if (!outfile.is_open())
+    return false;
+
+  int header[3] = {p.ir_phonons, p.raman_phonons, (int) distributions.cols()};
+  outfile.write("PHDIST01", 8);
+  outfile.write((const char *) header, sizeof(header));
+
+  Matrix<float, Dynamic, Dynamic> table = distributions.cast<float>();
+  outfile.write((const char *) table.data(), table.size() * sizeof(float));
+  outfile.close();
+  return true;
+}
@@ -91,3 +91,4 @@ do
 done
 
 printf "Done\n"
+printf "You can now run \"cached-run.sh\" to compute every point, reusing cached results.\n"
@@ -0,0 +1,232 @@
+/*
+  A single appendable binary container for the results of a sweep.
+
+  The file is a sequence of self-describing records, one per sweep point. Every record
+  holds the values of "parameters.inp" and a list of typed columns (eigenvalues, mean
+  phonons, ...) stored contiguously, so a whole sweep is scanned with one sequential
+  read of a memory-mapped file. Layout of a record (native byte order, 8-byte aligned):
+
+    record_header   magic, total size in bytes, the 12 parameters, number of columns
+    column_header   name, type and length of the first column
+    data            length values of the first column
+    column_header   ...
+
+  Appends take an exclusive flock, so several workers can append to the same store
+  concurrently. Under the lock the writer drops a truncated record left at the end of
+  the file by a killed writer, and skips the record if one with the same parameters is
+  already stored. The reader skips a damaged record and resynchronizes on the magic of
+  the next one.
+ */
+
+#ifndef THREE_SITES_LINEAR_RESULTS_STORE_H
+#define THREE_SITES_LINEAR_RESULTS_STORE_H
+
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+#include "model.h"
+
+static const char results_record_magic[8] = {'Q', 'M', 'R', 'E', 'C', '0', '0', '1'};
+
+enum results_column_type { results_float64 = 0 };
+
+struct results_record_header {
+  char magic[8];
+  uint64_t bytes;           // size of the whole record, this header included
+  double parameters[12];    // in the order of "parameters.inp"
+  uint32_t columns;
+  uint32_t reserved;
+};
+
+struct results_column_header {
+  char name[48];
+  uint32_t type;            // a results_column_type
+  uint32_t reserved;
+  uint64_t length;          // number of values
+};
+
+// Whether the "bytes" bytes at "data" start with a complete record
+inline bool results_record_valid (const char *data, size_t bytes)
+{
+  const results_record_header *h = (const results_record_header *) data;
+  if (bytes < sizeof(*h) || memcmp(h->magic, results_record_magic, 8) != 0 ||
+      h->bytes < sizeof(*h) || h->bytes > bytes || h->bytes % 8 != 0)
+    return false;
+  size_t offset = sizeof(*h);
+  for (uint32_t c = 0; c < h->columns; c++) {
+    if (offset + sizeof(results_column_header) > h->bytes)
+      return false;
+    const results_column_header *column = (const results_column_header *) (data + offset);
+    offset += sizeof(results_column_header);
+    if (column->length > (h->bytes - offset) / 8)
+      return false;
+    offset += column->length * 8;
+  }
+  return offset == h->bytes;
+}
+
+// Indexes the valid records of a mapped store. Records are 8-byte aligned, so after a
+// damaged one the scan resumes at the next aligned magic. Returns the end of the last
+// valid record.
+inline size_t results_scan (const char *data, size_t bytes, std::vector<const results_record_header *> &records)
+{
+  size_t offset = 0, end = 0;
+  while (offset + sizeof(results_record_header) <= bytes) {
+    if (results_record_valid(data + offset, bytes - offset)) {
+      const results_record_header *h = (const results_record_header *) (data + offset);
+      records.push_back(h);
+      offset += h->bytes;
+      end = offset;
+    }
+    else
+      offset += 8;
+  }
+  return end;
+}
+
+// One record being prepared for writing
+class results_record {
+public:
+  results_record (const model_parameters &p) {
+    double values[12] = {p.band_energy[0], p.band_energy[1], p.band_energy[2],
+			 p.nn_hopping, p.on_site_repulsion, p.ir_energy, p.e_ir_coupling,
+			 p.raman_energy, p.e_ram_coupling, p.raman_shift,
+			 (double) p.ir_phonons, (double) p.raman_phonons};
+    results_record_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, results_record_magic, 8);
+    memcpy(header.parameters, values, sizeof(values));
+    buffer.assign((const char *) &header, (const char *) &header + sizeof(header));
+  }
+
+  void add_column (const std::string &name, const Eigen::VectorXd &values) {
+    results_column_header column;
+    memset(&column, 0, sizeof(column));
+    strncpy(column.name, name.c_str(), sizeof(column.name) - 1);
+    column.type = results_float64;
+    column.length = values.size();
+    buffer.insert(buffer.end(), (const char *) &column, (const char *) &column + sizeof(column));
+    buffer.insert(buffer.end(), (const char *) values.data(), (const char *) (values.data() + values.size()));
+    header()->columns++;
+  }
+
+  // Appends the record to the store "filename", creating it if needed. If a record with
+  // the same parameters is already stored nothing is written and "duplicate" is set.
+  bool append (const char *filename, bool *duplicate = NULL) {
+    header()->bytes = buffer.size();
+    if (duplicate)
+      *duplicate = false;
+    int fd = open(filename, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    bool ok = flock(fd, LOCK_EX) == 0 && fstat(fd, &st) == 0;
+
+    // Find the end of the last valid record and look for the same parameters
+    size_t end = 0;
+    bool found = false;
+    if (ok && st.st_size > 0) {
+      void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      ok = map != MAP_FAILED;
+      if (ok) {
+	std::vector<const results_record_header *> records;
+	end = results_scan((const char *) map, st.st_size, records);
+	for (size_t r = 0; r < records.size() && !found; r++)
+	  found = memcmp(records[r]->parameters, header()->parameters, sizeof(header()->parameters)) == 0;
+	munmap(map, st.st_size);
+      }
+    }
+    if (found) {
+      if (duplicate)
+	*duplicate = true;
+      close(fd);
+      return ok;
+    }
+
+    // Drop a truncated tail, so that the new record can be read back
+    if (ok && end < (size_t) st.st_size)
+      ok = ftruncate(fd, end) == 0;
+    size_t written = 0;
+    while (ok && written < buffer.size()) {
+      ssize_t n = pwrite(fd, &buffer[written], buffer.size() - written, end + written);
+      if (n < 0 && errno == EINTR)
+	continue;
+      ok = n > 0;
+      if (ok)
+	written += n;
+    }
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+    return ok;
+  }
+
+private:
+  results_record_header *header () { return (results_record_header *) &buffer[0]; }
+  std::vector<char> buffer;
+};
+
+// Read-only, memory-mapped view of a store
+class results_store {
+public:
+  results_store () : data(NULL), bytes(0) {}
+  ~results_store () { if (data) munmap((void *) data, bytes); }
+
+  bool open (const char *filename) {
+    int fd = ::open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0)
+      return false;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return false;
+    }
+    if (st.st_size == 0) {
+      close(fd);
+      return true;
+    }
+    bytes = st.st_size;
+    void *map = mmap(NULL, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+      bytes = 0;
+      return false;
+    }
+    madvise(map, bytes, MADV_SEQUENTIAL);
+    data = (const char *) map;
+
+    results_scan(data, bytes, records);
+    return true;
+  }
+
+  size_t size () const { return records.size(); }
+
+  const double *parameters (size_t record) const { return records[record]->parameters; }
+
+  // The values of column "name" of a record, or an empty map if it is not there
+  Eigen::Map<const Eigen::VectorXd> column (size_t record, const std::string &name) const {
+    const char *p = (const char *) records[record] + sizeof(results_record_header);
+    for (uint32_t c = 0; c < records[record]->columns; c++) {
+      const results_column_header *column = (const results_column_header *) p;
+      p += sizeof(results_column_header);
+      if (column->type == results_float64 && name == column->name)
+	return Eigen::Map<const Eigen::VectorXd>((const double *) p, column->length);
+      p += column->length * 8;
+    }
+    return Eigen::Map<const Eigen::VectorXd>(NULL, 0);
+  }
+
+private:
+  const char *data;
+  size_t bytes;
+  std::vector<const results_record_header *> records;
+};
+
+#endif // THREE_SITES_LINEAR_RESULTS_STORE_H
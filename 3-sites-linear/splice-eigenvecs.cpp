@@ -1,10 +1,12 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
 #include <fstream>
 #include <cmath>
 #include <sstream>
 #include <Eigen/Dense>
+#include "profile.h"
 
 using namespace std;
 using namespace Eigen;
@@ -21,8 +23,12 @@ int main (int argc, char *argv[]) {
 
   int e1, e2, ir, ram, row, col, n;  // just counters
 
+  if (argc > 1 && strcmp(argv[1], "--profile") == 0)
+    profile::enable("splice-eigenvecs");
+
   ifstream inputfile;
   string line, val;
+  profile::phase read_timer("read");
   // Reading calculation parameters
   inputfile.open("parameters.inp");
   if (inputfile.is_open()) {
@@ -104,12 +110,14 @@ int main (int argc, char *argv[]) {
     cout << "eigenvectors.txt not found. " << endl;
     return 1;
   }
+  read_timer.stop();
 
   VectorXd one_vec = VectorXd::Zero(size);
   stringstream sstm;
   string filename;
 
   // Save each vector
+  profile::phase write_timer("write");
   for (col = 0; col < 20; col++) {
     for (row = 0; row < size; row++) {
       one_vec(row) = eigenvectors(row, col);
@@ -120,7 +128,9 @@ int main (int argc, char *argv[]) {
     sstm.clear();
     sstm.str("");
   }
-	    
+  write_timer.stop();
+
+  profile::report();
   return 0;
 }
 
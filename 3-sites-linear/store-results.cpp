@@ -0,0 +1,115 @@
+/*
+  Collects the results of sweep points into a single binary store (see results-store.h)
+  and prints them back.
+
+    store-results append store [directory ...]
+        appends one record per calculation directory (default: the current one) with
+        its parameters and every result file found there, unless the store already
+        holds a record with the same parameters.
+
+    store-results dump store [column]
+        prints one line per record: the 12 parameters followed by the values of
+        "column" (default: eigenvalues).
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <Eigen/Dense>
+#include "model.h"
+#include "results-store.h"
+
+using namespace std;
+using namespace Eigen;
+
+// Result files written by the other tools and the column they are stored in
+const char *result_files[][2] = {
+  {"eigenvalues.txt", "eigenvalues"},
+  {"mean_ir.txt", "mean_ir"},
+  {"mean_ram.txt", "mean_ram"},
+  {"stdd_ir.txt", "stdd_ir"},
+  {"stdd_ram.txt", "stdd_ram"},
+  {"entanglement_entropy.txt", "entanglement_entropy"}
+};
+
+bool read_vector(string, VectorXd&);
+int append(const char*, int, char**);
+int dump(const char*, string);
+
+int main (int argc, char *argv[]) {
+  if (argc >= 3 && strcmp(argv[1], "append") == 0)
+    return append(argv[2], argc - 3, argv + 3);
+  if ((argc == 3 || argc == 4) && strcmp(argv[1], "dump") == 0)
+    return dump(argv[2], argc == 4 ? argv[3] : "eigenvalues");
+
+  cout << "usage: store-results append store [directory ...]\n"
+       << "       store-results dump store [column]" << endl;
+  return 1;
+}
+
+int append(const char *store, int count, char **directories) {
+  const char *here = ".";
+  if (count == 0) {
+    count = 1;
+    directories = (char **) &here;
+  }
+
+  for (int d = 0; d < count; d++) {
+    string dir = string(directories[d]) + "/";
+    model_parameters p;
+    if (!read_parameters((dir + "parameters.inp").c_str(), p)) {
+      cout << "There's no \"parameters.inp\" in " << directories[d] << ", I will skip it." << endl;
+      continue;
+    }
+
+    results_record record(p);
+    for (size_t f = 0; f < sizeof(result_files) / sizeof(result_files[0]); f++) {
+      VectorXd values;
+      if (read_vector(dir + result_files[f][0], values))
+	record.add_column(result_files[f][1], values);
+    }
+
+    bool duplicate;
+    if (!record.append(store, &duplicate)) {
+      cout << "Unable to append to " << store << endl;
+      return 1;
+    }
+    if (duplicate)
+      cout << "The results of " << directories[d] << " are already in " << store << "." << endl;
+  }
+  return 0;
+}
+
+int dump(const char *filename, string column) {
+  results_store store;
+  if (!store.open(filename)) {
+    cout << "I couldn't open the store: " << filename << endl;
+    return 1;
+  }
+
+  for (size_t r = 0; r < store.size(); r++) {
+    const double *parameters = store.parameters(r);
+    for (int i = 0; i < 12; i++)
+      printf("%.10g ", parameters[i]);
+    Map<const VectorXd> values = store.column(r, column);
+    for (int i = 0; i < values.size(); i++)
+      printf(" %.17g", values(i));
+    printf("\n");
+  }
+  return 0;
+}
+
+bool read_vector(string filename, VectorXd &vec) {
+  ifstream infile(filename.c_str());
+  vector<double> values;
+  double x;
+  if (!infile.is_open())
+    return false;
+  while (infile >> x)
+    values.push_back(x);
+  vec = Map<VectorXd>(values.data(), values.size());
+  return true;
+}
@@ -0,0 +1,90 @@
+/*
+  Computes the transition matrix elements <i|O|j> between the lowest eigenstates for
+  the electronic dipole (rho_3 - rho_1) and the infrared and Raman phonon displacements
+  (a_ir + a_ir^dagger and a_R + a_R^dagger). Reads "parameters.inp" and "eigenvectors.txt"
+  and writes one k x k matrix per operator.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include "model.h"
+#include "observables.h"
+
+using namespace std;
+using namespace Eigen;
+
+IOFormat LongPrinting(20);
+
+void save_matrix(string, MatrixXd);
+
+const char *usage = "usage: transitions [k]\n       where 'k' is the number of eigenstates to use (default 20).";
+
+int main (int argc, char *argv[]) {
+  model_parameters p;
+  int size, states = 20;
+
+  if (argc > 2) {
+    cout << usage << endl;
+    return 1;
+  }
+
+  if (!read_parameters("parameters.inp", p)) {
+    cout << "Input file \"parameters.inp\" not found. I can't proceed any further. " << endl;
+    return 1;
+  }
+
+  size = basis_size(p);
+  if (states > size)
+    states = size;
+  if (argc == 2 && !parse_states(argv[1], size, states)) {
+    cout << "'k' must be a number of eigenstates between 1 and " << size << ".\n" << usage << endl;
+    return 1;
+  }
+
+  MatrixXd eigenvectors;
+  if (read_columns("eigenvectors.txt", size, states, eigenvectors)) {
+    cout << "Using the first " << eigenvectors.cols() << " eigenvectors of size " << eigenvectors.rows() << endl;
+  }
+  else {
+    cout << "eigenvectors.txt not found. " << endl;
+    return 1;
+  }
+
+  cout << "Calculating transition matrix elements. ";
+  MatrixXd dipole = transition_elements(dipole_operator(p), eigenvectors);
+  MatrixXd ir_displacement = transition_elements(displacement_operator(p, true), eigenvectors);
+  MatrixXd raman_displacement = transition_elements(displacement_operator(p, false), eigenvectors);
+  cout << "Done. " << endl;
+
+  cout << "Saving dipole transitions at \"dipole_transitions.txt\"... ";
+  save_matrix("dipole_transitions.txt", dipole);
+  cout << "Done. " << endl;
+
+  cout << "Saving infrared displacement transitions at \"ir_transitions.txt\"... ";
+  save_matrix("ir_transitions.txt", ir_displacement);
+  cout << "Done. " << endl;
+
+  cout << "Saving raman displacement transitions at \"raman_transitions.txt\"... ";
+  save_matrix("raman_transitions.txt", raman_displacement);
+  cout << "Done. " << endl;
+
+  return 0;
+}
+
+void save_matrix(string filename, MatrixXd m) {
+  ofstream outfile;
+  outfile.open(filename.c_str(), ios::out);
+  if(outfile.is_open()) {
+    outfile << m.format(LongPrinting);
+    outfile << endl;
+    outfile.close();
+  }
+  else {
+    cout << "Unable to create file." << endl;
+  }
+  return;
+}
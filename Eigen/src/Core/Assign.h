@@ -386,6 +386,34 @@ struct unaligned_assign_impl<false>
   }
 };
 
+// Handles the unaligned head or tail [start,end) of a linear vectorized assignment. When the packets
+// support masks, the range is covered by the last full packet overlapping it, of which only the
+// coefficients inside the range are stored. This requires size >= packetSize.
+template <bool Masked = false>
+struct masked_assign_impl
+{
+  template <typename Derived, typename OtherDerived>
+  static EIGEN_STRONG_INLINE void run(const Derived& src, OtherDerived& dst, typename Derived::Index start, typename Derived::Index end)
+  {
+    unaligned_assign_impl<>::run(src,dst,start,end);
+  }
+};
+
+template <>
+struct masked_assign_impl<true>
+{
+  template <typename Derived, typename OtherDerived>
+  static EIGEN_STRONG_INLINE void run(const Derived& src, OtherDerived& dst, typename Derived::Index start, typename Derived::Index end)
+  {
+    typedef typename Derived::Index Index;
+    enum { packetSize = packet_traits<typename OtherDerived::Scalar>::size };
+    if(start==end)
+      return;
+    const Index index = (std::min)(start, Index(dst.size()-packetSize));
+    dst.template copyPacketMasked<Derived, Unaligned>(index, src, start-index, end-index);
+  }
+};
+
 template<typename Derived1, typename Derived2, int Version>
 struct assign_impl<Derived1, Derived2, LinearVectorizedTraversal, NoUnrolling, Version>
 {
@@ -397,20 +425,27 @@ struct assign_impl<Derived1, Derived2, LinearVectorizedTraversal, NoUnrolling, V
     enum {
       packetSize = PacketTraits::size,
       dstAlignment = PacketTraits::AlignedOnScalar ? Aligned : int(assign_traits<Derived1,Derived2>::DstIsAligned) ,
-      srcAlignment = assign_traits<Derived1,Derived2>::JointAlignment
+      srcAlignment = assign_traits<Derived1,Derived2>::JointAlignment,
+      MaskedEnds = PacketTraits::HasMasks && (int(Derived1::Flags)&DirectAccessBit)
     };
     const Index alignedStart = assign_traits<Derived1,Derived2>::DstIsAligned ? 0
                              : internal::first_aligned(&dst.coeffRef(0), size);
     const Index alignedEnd = alignedStart + ((size-alignedStart)/packetSize)*packetSize;
 
-    unaligned_assign_impl<assign_traits<Derived1,Derived2>::DstIsAligned!=0>::run(src,dst,0,alignedStart);
+    if(MaskedEnds && size >= packetSize)
+      masked_assign_impl<MaskedEnds!=0>::run(src,dst,0,alignedStart);
+    else
+      unaligned_assign_impl<assign_traits<Derived1,Derived2>::DstIsAligned!=0>::run(src,dst,0,alignedStart);
 
     for(Index index = alignedStart; index < alignedEnd; index += packetSize)
     {
       dst.template copyPacket<Derived2, dstAlignment, srcAlignment>(index, src);
     }
 
-    unaligned_assign_impl<>::run(src,dst,alignedEnd,size);
+    if(MaskedEnds && size >= packetSize)
+      masked_assign_impl<MaskedEnds!=0>::run(src,dst,alignedEnd,size);
+    else
+      unaligned_assign_impl<>::run(src,dst,alignedEnd,size);
   }
 };
 
@@ -476,7 +511,56 @@ struct assign_impl<Derived1, Derived2, SliceVectorizedTraversal, NoUnrolling, Ve
 } // end namespace internal
 
 /***************************************************************************
-* Part 4 : implementation of DenseBase methods
+* Part 4 : parallel first touch of large constant fills
+***************************************************************************/
+
+namespace internal {
+
+template<typename Index, typename Functor> void parallel_for(Index size, Index grain, const Functor& func);
+
+template<typename Scalar> struct constant_fill_range
+{
+  constant_fill_range(Scalar* data, const Scalar& value) : m_data(data), m_value(value) {}
+  template<typename Index> void operator()(Index first, Index last) const
+  { std::fill(m_data + first, m_data + last, m_value); }
+  Scalar* m_data;
+  Scalar m_value;
+};
+
+/** \internal Fills a large contiguous destination with a constant from several threads, so that the
+  * pages of a freshly allocated matrix are first touched, and placed on their NUMA node, by the
+  * threads instead of all landing on the node of the allocating thread.
+  * \returns false when the assignment has to be done by assign_impl.
+  */
+template<typename Derived, typename OtherDerived,
+         bool Contiguous = (int(traits<Derived>::Flags) & DirectAccessBit) && (int(traits<Derived>::Flags) & LinearAccessBit)
+                        && int(Derived::InnerStrideAtCompileTime) == 1>
+struct parallel_constant_fill
+{
+  static EIGEN_STRONG_INLINE bool run(Derived&, const OtherDerived&) { return false; }
+};
+
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_THREAD_POOL)
+template<typename Derived, typename Scalar, typename PlainObjectType>
+struct parallel_constant_fill<Derived, CwiseNullaryOp<scalar_constant_op<Scalar>, PlainObjectType>, true>
+{
+  typedef typename Derived::Index Index;
+  static bool run(Derived& dst, const CwiseNullaryOp<scalar_constant_op<Scalar>, PlainObjectType>& src)
+  {
+    const Index size = dst.size();
+    if(size*Index(sizeof(Scalar)) < Index(EIGEN_PARALLEL_FILL_THRESHOLD))
+      return false;
+    // one page per thread at least
+    parallel_for(size, Index(4096/sizeof(Scalar)), constant_fill_range<Scalar>(&dst.coeffRef(0), src.coeff(0)));
+    return true;
+  }
+};
+#endif // EIGEN_HAS_OPENMP || EIGEN_HAS_THREAD_POOL
+
+} // end namespace internal
+
+/***************************************************************************
+* Part 5 : implementation of DenseBase methods
 ***************************************************************************/
 
 template<typename Derived>
@@ -496,8 +580,9 @@ EIGEN_STRONG_INLINE Derived& DenseBase<Derived>
   internal::assign_traits<Derived, OtherDerived>::debug();
 #endif
   eigen_assert(rows() == other.rows() && cols() == other.cols());
-  internal::assign_impl<Derived, OtherDerived, int(SameType) ? int(internal::assign_traits<Derived, OtherDerived>::Traversal)
-                                                       : int(InvalidTraversal)>::run(derived(),other.derived());
+  if(!internal::parallel_constant_fill<Derived, OtherDerived>::run(derived(), other.derived()))
+    internal::assign_impl<Derived, OtherDerived, int(SameType) ? int(internal::assign_traits<Derived, OtherDerived>::Traversal)
+                                                         : int(InvalidTraversal)>::run(derived(),other.derived());
 #ifndef EIGEN_NO_DEBUG
   checkTransposeAliasing(other.derived());
 #endif
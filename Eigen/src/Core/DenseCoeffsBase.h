@@ -690,6 +690,21 @@ class DenseCoeffsBase<Derived, DirectWriteAccessors>
     {
       return Derived::IsRowMajor ? innerStride() : outerStride();
     }
+
+#ifndef EIGEN_PARSED_BY_DOXYGEN
+    /** \internal Copies the coefficients \a begin to \a end-1 of the packet at the given index of other
+      * into the corresponding coefficients of *this with a masked store, leaving the others untouched.
+      *
+      * This method is overridden in SwapWrapper and SelfCwiseBinaryOp, like copyPacket().
+      */
+    template<typename OtherDerived, int LoadMode>
+    EIGEN_STRONG_INLINE void copyPacketMasked(Index index, const DenseBase<OtherDerived>& other, Index begin, Index end)
+    {
+      eigen_internal_assert(index >= 0 && index + internal::packet_traits<Scalar>::size <= size());
+      internal::pstoreu_masked(&derived().coeffRef(index),
+        other.derived().template packet<LoadMode>(index), begin, end);
+    }
+#endif
 };
 
 namespace internal {
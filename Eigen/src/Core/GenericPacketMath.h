@@ -52,6 +52,7 @@ struct default_packet_traits
     HasMax    = 1,
     HasConj   = 1,
     HasSetLinear = 1,
+    HasMasks  = 0,
 
     HasDiv    = 0,
     HasSqrt   = 0,
@@ -299,6 +300,41 @@ inline void pstoret(Scalar* to, const Packet& from)
     pstoreu(to, from);
 }
 
+/** \internal \returns a packet made of the elements of \a a before \a split and of the elements of \a b
+  * from \a split on. With HasMasks, this is used to apply a packet operation to a part of a packet only. */
+template<typename Packet> inline Packet
+pblend(const Packet& a, const Packet& b, DenseIndex split)
+{
+  typedef typename unpacket_traits<Packet>::type Scalar;
+  Scalar elements[unpacket_traits<Packet>::size], others[unpacket_traits<Packet>::size];
+  pstoreu(elements, a);
+  pstoreu(others, b);
+  for(DenseIndex i = split; i < DenseIndex(unpacket_traits<Packet>::size); ++i)
+    elements[i] = others[i];
+  return ploadu<Packet>(elements);
+}
+
+/** \internal copy the elements \a begin to \a end-1 of the packet \a from to \a to[begin] ... \a to[end-1]
+  * without touching the other elements of \a to. With HasMasks, this is a single masked store. */
+template<typename Scalar, typename Packet> inline void
+pstoreu_masked(Scalar* to, const Packet& from, DenseIndex begin, DenseIndex end)
+{
+  Scalar elements[unpacket_traits<Packet>::size];
+  pstoreu(elements, from);
+  for(DenseIndex i = begin; i < end; ++i)
+    to[i] = elements[i];
+}
+
+/** \internal \returns the packet made of \a from[\a indices[0]], \a from[\a indices[1]], ... */
+template<typename Packet, typename Scalar, typename IndexType> inline Packet
+pgather(const Scalar* from, const IndexType* indices)
+{
+  EIGEN_ALIGN16 Scalar elements[unpacket_traits<Packet>::size];
+  for(DenseIndex i = 0; i < DenseIndex(unpacket_traits<Packet>::size); ++i)
+    elements[i] = from[indices[i]];
+  return pload<Packet>(elements);
+}
+
 /** \internal default implementation of palign() allowing partial specialization */
 template<int Offset,typename PacketType>
 struct palign_impl
@@ -227,13 +227,27 @@ struct redux_impl<Func, Derived, LinearVectorizedTraversal, NoUnrolling>
         if(alignedEnd>alignedEnd2)
           packet_res0 = func.packetOp(packet_res0, mat.template packet<alignment>(alignedEnd2));
       }
-      res = func.predux(packet_res0);
+      if(packet_traits<Scalar>::HasMasks)
+      {
+        // fold the unaligned head and tail in as full packets overlapping them,
+        // keeping only the lanes of the accumulator which fall inside the head or the tail
+        if(alignedStart>0)
+          packet_res0 = internal::pblend(func.packetOp(packet_res0, mat.template packet<Unaligned>(0)), packet_res0, alignedStart);
+        if(alignedEnd<size)
+          packet_res0 = internal::pblend(packet_res0, func.packetOp(packet_res0, mat.template packet<Unaligned>(size-packetSize)),
+                                         packetSize-(size-alignedEnd));
+        res = func.predux(packet_res0);
+      }
+      else
+      {
+        res = func.predux(packet_res0);
 
-      for(Index index = 0; index < alignedStart; ++index)
-        res = func(res,mat.coeff(index));
+        for(Index index = 0; index < alignedStart; ++index)
+          res = func(res,mat.coeff(index));
 
-      for(Index index = alignedEnd; index < size; ++index)
-        res = func(res,mat.coeff(index));
+        for(Index index = alignedEnd; index < size; ++index)
+          res = func(res,mat.coeff(index));
+      }
     }
     else // too small to vectorize anything.
          // since this is dynamic-size hence inefficient anyway for such small sizes, don't try to optimize.
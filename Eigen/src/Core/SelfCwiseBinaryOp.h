@@ -122,6 +122,15 @@ template<typename BinaryOp, typename Lhs, typename Rhs> class SelfCwiseBinaryOp
         m_functor.packetOp(m_matrix.template packet<StoreMode>(index),_other.template packet<LoadMode>(index)) );
     }
 
+    template<typename OtherDerived, int LoadMode>
+    void copyPacketMasked(Index index, const DenseBase<OtherDerived>& other, Index begin, Index end)
+    {
+      OtherDerived& _other = other.const_cast_derived();
+      eigen_internal_assert(index >= 0 && index < m_matrix.size());
+      internal::pstoreu_masked(&m_matrix.coeffRef(index),
+        m_functor.packetOp(m_matrix.template packet<Unaligned>(index),_other.template packet<LoadMode>(index)), begin, end);
+    }
+
     // reimplement lazyAssign to handle complex *= real
     // see CwiseBinaryOp ctor for details
     template<typename RhsDerived>
@@ -115,6 +115,13 @@ template<typename ExpressionType> class SwapWrapper
       _other.template writePacket<LoadMode>(index, tmp);
     }
 
+    template<typename OtherDerived, int LoadMode>
+    void copyPacketMasked(Index index, const DenseBase<OtherDerived>& other, Index begin, Index end)
+    {
+      for(Index i = begin; i < end; ++i)
+        copyCoeff(index+i, other);
+    }
+
     ExpressionType& expression() const { return m_expression; }
 
   protected:
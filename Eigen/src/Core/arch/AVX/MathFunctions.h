@@ -0,0 +1,68 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_MATH_FUNCTIONS_AVX_H
+#define EIGEN_MATH_FUNCTIONS_AVX_H
+
+namespace Eigen {
+
+namespace internal {
+
+// The transcendental functions apply the SSE versions to both halves of the packet
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet8f plog<Packet8f>(const Packet8f& x)
+{
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(plog<Packet4f>(_mm256_castps256_ps128(x))),
+                              plog<Packet4f>(_mm256_extractf128_ps(x,1)), 1);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet8f pexp<Packet8f>(const Packet8f& x)
+{
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(pexp<Packet4f>(_mm256_castps256_ps128(x))),
+                              pexp<Packet4f>(_mm256_extractf128_ps(x,1)), 1);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet8f psin<Packet8f>(const Packet8f& x)
+{
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(psin<Packet4f>(_mm256_castps256_ps128(x))),
+                              psin<Packet4f>(_mm256_extractf128_ps(x,1)), 1);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet8f pcos<Packet8f>(const Packet8f& x)
+{
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(pcos<Packet4f>(_mm256_castps256_ps128(x))),
+                              pcos<Packet4f>(_mm256_extractf128_ps(x,1)), 1);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4d pexp<Packet4d>(const Packet4d& x)
+{
+  return _mm256_insertf128_pd(_mm256_castpd128_pd256(pexp<Packet2d>(_mm256_castpd256_pd128(x))),
+                              pexp<Packet2d>(_mm256_extractf128_pd(x,1)), 1);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet8f psqrt<Packet8f>(const Packet8f& x)
+{
+  return _mm256_sqrt_ps(x);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet4d psqrt<Packet4d>(const Packet4d& x)
+{
+  return _mm256_sqrt_pd(x);
+}
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_MATH_FUNCTIONS_AVX_H
@@ -0,0 +1,297 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_PACKET_MATH_AVX_H
+#define EIGEN_PACKET_MATH_AVX_H
+
+namespace Eigen {
+
+namespace internal {
+
+// The AVX packets of float and double replace the SSE ones, which are still used for
+// integers and to reduce the two 128-bit halves of a packet.
+//
+// Eigen only guarantees 16-byte alignment, both on the heap and for fixed size objects,
+// so a data pointer said to be aligned may not be aligned on a 32-byte boundary. For this
+// reason the aligned loads and stores are performed with the unaligned instructions,
+// which are as fast as the aligned ones when the address happens to be 32-byte aligned.
+
+typedef __m256  Packet8f;
+typedef __m256d Packet4d;
+
+template<> struct is_arithmetic<__m256>  { enum { value = true }; };
+template<> struct is_arithmetic<__m256d> { enum { value = true }; };
+
+#ifdef EIGEN_VECTORIZE_FMA
+// a*b+c is a single instruction, see gebp_traits::madd()
+#define EIGEN_HAS_SINGLE_INSTRUCTION_MADD
+#endif
+
+#define _EIGEN_DECLARE_CONST_Packet8f(NAME,X) \
+  const Packet8f p8f_##NAME = pset1<Packet8f>(X)
+
+#define _EIGEN_DECLARE_CONST_Packet4d(NAME,X) \
+  const Packet4d p4d_##NAME = pset1<Packet4d>(X)
+
+
+// With AVX-512, float and double use the packets of arch/AVX512
+#ifndef EIGEN_VECTORIZE_AVX512
+template<> struct packet_traits<float>  : default_packet_traits
+{
+  typedef Packet8f type;
+  enum {
+    Vectorizable = 1,
+    AlignedOnScalar = 1,
+    size=8,
+
+    HasDiv  = 1,
+    HasSin  = EIGEN_FAST_MATH,
+    HasCos  = EIGEN_FAST_MATH,
+    HasLog  = 1,
+    HasExp  = 1,
+    HasSqrt = 1
+  };
+};
+template<> struct packet_traits<double> : default_packet_traits
+{
+  typedef Packet4d type;
+  enum {
+    Vectorizable = 1,
+    AlignedOnScalar = 1,
+    size=4,
+
+    HasDiv  = 1,
+    HasExp  = 1,
+    HasSqrt = 1
+  };
+};
+#endif
+
+template<> struct unpacket_traits<Packet8f> { typedef float  type; enum {size=8}; };
+template<> struct unpacket_traits<Packet4d> { typedef double type; enum {size=4}; };
+
+template<> EIGEN_STRONG_INLINE Packet8f pset1<Packet8f>(const float&  from) { return _mm256_set1_ps(from); }
+template<> EIGEN_STRONG_INLINE Packet4d pset1<Packet4d>(const double& from) { return _mm256_set1_pd(from); }
+
+#ifndef EIGEN_VECTORIZE_AVX512
+template<> EIGEN_STRONG_INLINE Packet8f plset<float>(const float& a) { return _mm256_add_ps(pset1<Packet8f>(a), _mm256_set_ps(7,6,5,4,3,2,1,0)); }
+template<> EIGEN_STRONG_INLINE Packet4d plset<double>(const double& a) { return _mm256_add_pd(pset1<Packet4d>(a), _mm256_set_pd(3,2,1,0)); }
+#endif
+
+template<> EIGEN_STRONG_INLINE Packet8f padd<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_add_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d padd<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_add_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f psub<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_sub_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d psub<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_sub_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f pnegate(const Packet8f& a)
+{
+  return _mm256_xor_ps(a,_mm256_set1_ps(-0.0f));
+}
+template<> EIGEN_STRONG_INLINE Packet4d pnegate(const Packet4d& a)
+{
+  return _mm256_xor_pd(a,_mm256_set1_pd(-0.0));
+}
+
+template<> EIGEN_STRONG_INLINE Packet8f pmul<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_mul_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d pmul<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_mul_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f pdiv<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_div_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d pdiv<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_div_pd(a,b); }
+
+#ifdef EIGEN_VECTORIZE_FMA
+template<> EIGEN_STRONG_INLINE Packet8f pmadd(const Packet8f& a, const Packet8f& b, const Packet8f& c) { return _mm256_fmadd_ps(a,b,c); }
+template<> EIGEN_STRONG_INLINE Packet4d pmadd(const Packet4d& a, const Packet4d& b, const Packet4d& c) { return _mm256_fmadd_pd(a,b,c); }
+#endif
+
+template<> EIGEN_STRONG_INLINE Packet8f pmin<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_min_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d pmin<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_min_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f pmax<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_max_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d pmax<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_max_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f pand<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_and_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d pand<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_and_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f por<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_or_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d por<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_or_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f pxor<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_xor_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d pxor<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_xor_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet8f pandnot<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_andnot_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet4d pandnot<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_andnot_pd(a,b); }
+
+// see the note at the top of the file about alignment
+template<> EIGEN_STRONG_INLINE Packet8f pload<Packet8f>(const float*   from) { EIGEN_DEBUG_ALIGNED_LOAD return _mm256_loadu_ps(from); }
+template<> EIGEN_STRONG_INLINE Packet4d pload<Packet4d>(const double*  from) { EIGEN_DEBUG_ALIGNED_LOAD return _mm256_loadu_pd(from); }
+
+template<> EIGEN_STRONG_INLINE Packet8f ploadu<Packet8f>(const float*  from) { EIGEN_DEBUG_UNALIGNED_LOAD return _mm256_loadu_ps(from); }
+template<> EIGEN_STRONG_INLINE Packet4d ploadu<Packet4d>(const double* from) { EIGEN_DEBUG_UNALIGNED_LOAD return _mm256_loadu_pd(from); }
+
+// [a0 a0 a1 a1 a2 a2 a3 a3]
+template<> EIGEN_STRONG_INLINE Packet8f ploaddup<Packet8f>(const float* from)
+{
+  Packet4f a = _mm_loadu_ps(from);
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(a,a)), _mm_unpackhi_ps(a,a), 1);
+}
+// [a0 a0 a1 a1]
+template<> EIGEN_STRONG_INLINE Packet4d ploaddup<Packet4d>(const double* from)
+{
+  Packet2d a = _mm_loadu_pd(from);
+  return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_unpacklo_pd(a,a)), _mm_unpackhi_pd(a,a), 1);
+}
+
+template<> EIGEN_STRONG_INLINE void pstore<float>(float*   to, const Packet8f& from) { EIGEN_DEBUG_ALIGNED_STORE _mm256_storeu_ps(to, from); }
+template<> EIGEN_STRONG_INLINE void pstore<double>(double* to, const Packet4d& from) { EIGEN_DEBUG_ALIGNED_STORE _mm256_storeu_pd(to, from); }
+
+template<> EIGEN_STRONG_INLINE void pstoreu<float>(float*   to, const Packet8f& from) { EIGEN_DEBUG_UNALIGNED_STORE _mm256_storeu_ps(to, from); }
+template<> EIGEN_STRONG_INLINE void pstoreu<double>(double* to, const Packet4d& from) { EIGEN_DEBUG_UNALIGNED_STORE _mm256_storeu_pd(to, from); }
+
+#ifdef EIGEN_VECTORIZE_AVX2
+template<> EIGEN_STRONG_INLINE Packet8f pgather<Packet8f,float,int>(const float* from, const int* indices)
+{
+  return _mm256_i32gather_ps(from, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), 4);
+}
+template<> EIGEN_STRONG_INLINE Packet4d pgather<Packet4d,double,int>(const double* from, const int* indices)
+{
+  return _mm256_i32gather_pd(from, _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices)), 8);
+}
+#endif
+
+template<> EIGEN_STRONG_INLINE float  pfirst<Packet8f>(const Packet8f& a) { return pfirst<Packet4f>(_mm256_castps256_ps128(a)); }
+template<> EIGEN_STRONG_INLINE double pfirst<Packet4d>(const Packet4d& a) { return pfirst<Packet2d>(_mm256_castpd256_pd128(a)); }
+
+template<> EIGEN_STRONG_INLINE Packet8f preverse(const Packet8f& a)
+{
+  Packet8f tmp = _mm256_shuffle_ps(a,a,0x1b);
+  return _mm256_permute2f128_ps(tmp, tmp, 1);
+}
+template<> EIGEN_STRONG_INLINE Packet4d preverse(const Packet4d& a)
+{
+  Packet4d tmp = _mm256_shuffle_pd(a,a,5);
+  return _mm256_permute2f128_pd(tmp, tmp, 1);
+}
+
+template<> EIGEN_STRONG_INLINE Packet8f pabs(const Packet8f& a)
+{
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f),a);
+}
+template<> EIGEN_STRONG_INLINE Packet4d pabs(const Packet4d& a)
+{
+  return _mm256_andnot_pd(_mm256_set1_pd(-0.0),a);
+}
+
+// The reductions add the two halves and finish with the SSE versions
+template<> EIGEN_STRONG_INLINE float predux<Packet8f>(const Packet8f& a)
+{
+  return predux<Packet4f>(_mm_add_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1)));
+}
+template<> EIGEN_STRONG_INLINE double predux<Packet4d>(const Packet4d& a)
+{
+  return predux<Packet2d>(_mm_add_pd(_mm256_castpd256_pd128(a),_mm256_extractf128_pd(a,1)));
+}
+
+template<> EIGEN_STRONG_INLINE Packet8f preduxp<Packet8f>(const Packet8f* vecs)
+{
+  // the two lanes of sum0123 hold the sums of the low and high halves of vecs[0..3]
+  Packet8f sum0123 = _mm256_hadd_ps(_mm256_hadd_ps(vecs[0], vecs[1]), _mm256_hadd_ps(vecs[2], vecs[3]));
+  Packet8f sum4567 = _mm256_hadd_ps(_mm256_hadd_ps(vecs[4], vecs[5]), _mm256_hadd_ps(vecs[6], vecs[7]));
+  return _mm256_add_ps(_mm256_permute2f128_ps(sum0123, sum4567, 0x20),
+                       _mm256_permute2f128_ps(sum0123, sum4567, 0x31));
+}
+template<> EIGEN_STRONG_INLINE Packet4d preduxp<Packet4d>(const Packet4d* vecs)
+{
+  Packet4d sum01 = _mm256_hadd_pd(vecs[0], vecs[1]);
+  Packet4d sum23 = _mm256_hadd_pd(vecs[2], vecs[3]);
+  return _mm256_add_pd(_mm256_permute2f128_pd(sum01, sum23, 0x20),
+                       _mm256_permute2f128_pd(sum01, sum23, 0x31));
+}
+
+template<> EIGEN_STRONG_INLINE float predux_mul<Packet8f>(const Packet8f& a)
+{
+  return predux_mul<Packet4f>(_mm_mul_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1)));
+}
+template<> EIGEN_STRONG_INLINE double predux_mul<Packet4d>(const Packet4d& a)
+{
+  return predux_mul<Packet2d>(_mm_mul_pd(_mm256_castpd256_pd128(a),_mm256_extractf128_pd(a,1)));
+}
+
+template<> EIGEN_STRONG_INLINE float predux_min<Packet8f>(const Packet8f& a)
+{
+  return predux_min<Packet4f>(_mm_min_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1)));
+}
+template<> EIGEN_STRONG_INLINE double predux_min<Packet4d>(const Packet4d& a)
+{
+  return predux_min<Packet2d>(_mm_min_pd(_mm256_castpd256_pd128(a),_mm256_extractf128_pd(a,1)));
+}
+
+template<> EIGEN_STRONG_INLINE float predux_max<Packet8f>(const Packet8f& a)
+{
+  return predux_max<Packet4f>(_mm_max_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1)));
+}
+template<> EIGEN_STRONG_INLINE double predux_max<Packet4d>(const Packet4d& a)
+{
+  return predux_max<Packet2d>(_mm_max_pd(_mm256_castpd256_pd128(a),_mm256_extractf128_pd(a,1)));
+}
+
+// Shifts the concatenation of a and b by Offset floats within each 128-bit lane,
+// i.e. lane i of the result is [a_i b_i] without its first Offset elements.
+template<int Offset>
+EIGEN_STRONG_INLINE Packet8f palign_lanes(const Packet8f& a, const Packet8f& b)
+{
+  if (Offset==1)
+    return _mm256_shuffle_ps(a, _mm256_shuffle_ps(a,b,_MM_SHUFFLE(0,0,3,3)), _MM_SHUFFLE(2,0,2,1));
+  else if (Offset==2)
+    return _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1,0,3,2));
+  else if (Offset==3)
+    return _mm256_shuffle_ps(_mm256_shuffle_ps(a,b,_MM_SHUFFLE(0,0,3,3)), b, _MM_SHUFFLE(2,1,2,0));
+  return a;
+}
+
+template<int Offset>
+struct palign_impl<Offset,Packet8f>
+{
+  static EIGEN_STRONG_INLINE void run(Packet8f& first, const Packet8f& second)
+  {
+    if (Offset!=0)
+    {
+      // the high half of first and the low half of second
+      Packet8f middle = _mm256_permute2f128_ps(first, second, 0x21);
+      if (Offset<4)
+        first = palign_lanes<Offset%4>(first, middle);
+      else if (Offset==4)
+        first = middle;
+      else
+        first = palign_lanes<Offset%4>(middle, second);
+    }
+  }
+};
+
+template<int Offset>
+struct palign_impl<Offset,Packet4d>
+{
+  static EIGEN_STRONG_INLINE void run(Packet4d& first, const Packet4d& second)
+  {
+    if (Offset!=0)
+    {
+      Packet4d middle = _mm256_permute2f128_pd(first, second, 0x21);
+      if (Offset==1)
+        first = _mm256_shuffle_pd(first, middle, 5);
+      else if (Offset==2)
+        first = middle;
+      else if (Offset==3)
+        first = _mm256_shuffle_pd(middle, second, 5);
+    }
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_PACKET_MATH_AVX_H
@@ -0,0 +1,392 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_COMPLEX_AVX512_H
+#define EIGEN_COMPLEX_AVX512_H
+
+namespace Eigen {
+
+namespace internal {
+
+//---------- float ----------
+struct Packet8cf
+{
+  EIGEN_STRONG_INLINE Packet8cf() {}
+  EIGEN_STRONG_INLINE explicit Packet8cf(const __m512& a) : v(a) {}
+  __m512  v;
+};
+
+template<> struct packet_traits<std::complex<float> >  : default_packet_traits
+{
+  typedef Packet8cf type;
+  enum {
+    Vectorizable = 1,
+    AlignedOnScalar = 1,
+    size = 8,
+
+    HasAdd    = 1,
+    HasSub    = 1,
+    HasMul    = 1,
+    HasDiv    = 1,
+    HasNegate = 1,
+    HasAbs    = 0,
+    HasAbs2   = 0,
+    HasMin    = 0,
+    HasMax    = 0,
+    HasSetLinear = 0,
+    HasMasks  = 1
+  };
+};
+
+template<> struct unpacket_traits<Packet8cf> { typedef std::complex<float> type; enum {size=8}; };
+
+EIGEN_STRONG_INLINE Packet4cf plower_half(const Packet8cf& a) { return Packet4cf(plower_half(a.v)); }
+EIGEN_STRONG_INLINE Packet4cf pupper_half(const Packet8cf& a) { return Packet4cf(pupper_half(a.v)); }
+EIGEN_STRONG_INLINE Packet8cf pcombine_halves(const Packet4cf& lower, const Packet4cf& upper)
+{ return Packet8cf(pcombine_halves(lower.v, upper.v)); }
+
+template<> EIGEN_STRONG_INLINE Packet8cf padd<Packet8cf>(const Packet8cf& a, const Packet8cf& b) { return Packet8cf(_mm512_add_ps(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet8cf psub<Packet8cf>(const Packet8cf& a, const Packet8cf& b) { return Packet8cf(_mm512_sub_ps(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet8cf pnegate(const Packet8cf& a) { return Packet8cf(pnegate(a.v)); }
+template<> EIGEN_STRONG_INLINE Packet8cf pconj(const Packet8cf& a)
+{
+  // -0.0 as a double only has the sign bit of the imaginary part set
+  return Packet8cf(pxor(a.v, _mm512_castpd_ps(_mm512_set1_pd(-0.0))));
+}
+
+// there is no vaddsubps in AVX-512, vfmaddsubps does the multiplication as well
+template<> EIGEN_STRONG_INLINE Packet8cf pmul<Packet8cf>(const Packet8cf& a, const Packet8cf& b)
+{
+  return Packet8cf(_mm512_fmaddsub_ps(_mm512_moveldup_ps(a.v), b.v,
+                                      _mm512_mul_ps(_mm512_movehdup_ps(a.v),
+                                                    _mm512_permute_ps(b.v, 0xb1))));
+}
+
+template<> EIGEN_STRONG_INLINE Packet8cf pand   <Packet8cf>(const Packet8cf& a, const Packet8cf& b) { return Packet8cf(pand(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet8cf por    <Packet8cf>(const Packet8cf& a, const Packet8cf& b) { return Packet8cf(por(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet8cf pxor   <Packet8cf>(const Packet8cf& a, const Packet8cf& b) { return Packet8cf(pxor(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet8cf pandnot<Packet8cf>(const Packet8cf& a, const Packet8cf& b) { return Packet8cf(pandnot(a.v,b.v)); }
+
+template<> EIGEN_STRONG_INLINE Packet8cf pload <Packet8cf>(const std::complex<float>* from) { EIGEN_DEBUG_ALIGNED_LOAD return Packet8cf(pload<Packet16f>(&real_ref(*from))); }
+template<> EIGEN_STRONG_INLINE Packet8cf ploadu<Packet8cf>(const std::complex<float>* from) { EIGEN_DEBUG_UNALIGNED_LOAD return Packet8cf(ploadu<Packet16f>(&real_ref(*from))); }
+
+template<> EIGEN_STRONG_INLINE Packet8cf pset1<Packet8cf>(const std::complex<float>& from)
+{
+  return Packet8cf(_mm512_castpd_ps(_mm512_broadcastsd_pd(_mm_load_sd(reinterpret_cast<const double*>(&from)))));
+}
+
+// [a0 a0 a1 a1 a2 a2 a3 a3]
+template<> EIGEN_STRONG_INLINE Packet8cf ploaddup<Packet8cf>(const std::complex<float>* from)
+{
+  return Packet8cf(_mm512_castpd_ps(_mm512_permutexvar_pd(_mm512_set_epi64(3,3,2,2,1,1,0,0),
+                                    _mm512_castpd256_pd512(_mm256_loadu_pd(reinterpret_cast<const double*>(from))))));
+}
+
+template<> EIGEN_STRONG_INLINE void pstore <std::complex<float> >(std::complex<float> *   to, const Packet8cf& from) { EIGEN_DEBUG_ALIGNED_STORE pstore(&real_ref(*to), from.v); }
+template<> EIGEN_STRONG_INLINE void pstoreu<std::complex<float> >(std::complex<float> *   to, const Packet8cf& from) { EIGEN_DEBUG_UNALIGNED_STORE pstoreu(&real_ref(*to), from.v); }
+
+template<> EIGEN_STRONG_INLINE Packet8cf pblend<Packet8cf>(const Packet8cf& a, const Packet8cf& b, DenseIndex split)
+{
+  return Packet8cf(pblend(a.v, b.v, 2*split));
+}
+template<> EIGEN_STRONG_INLINE void pstoreu_masked<std::complex<float> >(std::complex<float>* to, const Packet8cf& from, DenseIndex begin, DenseIndex end)
+{
+  pstoreu_masked(&real_ref(*to), from.v, 2*begin, 2*end);
+}
+
+template<> EIGEN_STRONG_INLINE std::complex<float>  pfirst<Packet8cf>(const Packet8cf& a)
+{
+  return pfirst(Packet2cf(_mm512_castps512_ps128(a.v)));
+}
+
+template<> EIGEN_STRONG_INLINE Packet8cf preverse(const Packet8cf& a)
+{
+  return Packet8cf(_mm512_castpd_ps(_mm512_permutexvar_pd(_mm512_set_epi64(0,1,2,3,4,5,6,7), _mm512_castps_pd(a.v))));
+}
+
+// The reductions combine the two halves and finish with the AVX versions
+template<> EIGEN_STRONG_INLINE std::complex<float> predux<Packet8cf>(const Packet8cf& a)
+{
+  return predux(padd(plower_half(a), pupper_half(a)));
+}
+
+template<> EIGEN_STRONG_INLINE Packet8cf preduxp<Packet8cf>(const Packet8cf* vecs)
+{
+  Packet4cf halves[8];
+  for(int i = 0; i < 8; ++i)
+    halves[i] = padd(plower_half(vecs[i]), pupper_half(vecs[i]));
+  return pcombine_halves(preduxp(halves), preduxp(halves+4));
+}
+
+template<> EIGEN_STRONG_INLINE std::complex<float> predux_mul<Packet8cf>(const Packet8cf& a)
+{
+  return predux_mul(pmul(plower_half(a), pupper_half(a)));
+}
+
+template<int Offset>
+struct palign_impl<Offset,Packet8cf>
+{
+  static EIGEN_STRONG_INLINE void run(Packet8cf& first, const Packet8cf& second)
+  {
+    palign_impl<2*Offset,Packet16f>::run(first.v, second.v);
+  }
+};
+
+template<> struct conj_helper<Packet8cf, Packet8cf, false,true>
+{
+  EIGEN_STRONG_INLINE Packet8cf pmadd(const Packet8cf& x, const Packet8cf& y, const Packet8cf& c) const
+  { return padd(pmul(x,y),c); }
+
+  EIGEN_STRONG_INLINE Packet8cf pmul(const Packet8cf& a, const Packet8cf& b) const
+  {
+    return internal::pmul(a, pconj(b));
+  }
+};
+
+template<> struct conj_helper<Packet8cf, Packet8cf, true,false>
+{
+  EIGEN_STRONG_INLINE Packet8cf pmadd(const Packet8cf& x, const Packet8cf& y, const Packet8cf& c) const
+  { return padd(pmul(x,y),c); }
+
+  EIGEN_STRONG_INLINE Packet8cf pmul(const Packet8cf& a, const Packet8cf& b) const
+  {
+    return internal::pmul(pconj(a), b);
+  }
+};
+
+template<> struct conj_helper<Packet8cf, Packet8cf, true,true>
+{
+  EIGEN_STRONG_INLINE Packet8cf pmadd(const Packet8cf& x, const Packet8cf& y, const Packet8cf& c) const
+  { return padd(pmul(x,y),c); }
+
+  EIGEN_STRONG_INLINE Packet8cf pmul(const Packet8cf& a, const Packet8cf& b) const
+  {
+    return pconj(internal::pmul(a, b));
+  }
+};
+
+template<> struct conj_helper<Packet16f, Packet8cf, false,false>
+{
+  EIGEN_STRONG_INLINE Packet8cf pmadd(const Packet16f& x, const Packet8cf& y, const Packet8cf& c) const
+  { return padd(c, pmul(x,y)); }
+
+  EIGEN_STRONG_INLINE Packet8cf pmul(const Packet16f& x, const Packet8cf& y) const
+  { return Packet8cf(Eigen::internal::pmul(x, y.v)); }
+};
+
+template<> struct conj_helper<Packet8cf, Packet16f, false,false>
+{
+  EIGEN_STRONG_INLINE Packet8cf pmadd(const Packet8cf& x, const Packet16f& y, const Packet8cf& c) const
+  { return padd(c, pmul(x,y)); }
+
+  EIGEN_STRONG_INLINE Packet8cf pmul(const Packet8cf& x, const Packet16f& y) const
+  { return Packet8cf(Eigen::internal::pmul(x.v, y)); }
+};
+
+template<> EIGEN_STRONG_INLINE Packet8cf pdiv<Packet8cf>(const Packet8cf& a, const Packet8cf& b)
+{
+  Packet8cf res = conj_helper<Packet8cf,Packet8cf,false,true>().pmul(a,b);
+  __m512 s = _mm512_mul_ps(b.v,b.v);
+  return Packet8cf(_mm512_div_ps(res.v,_mm512_add_ps(s,_mm512_permute_ps(s, 0xb1))));
+}
+
+EIGEN_STRONG_INLINE Packet8cf pcplxflip/*<Packet8cf>*/(const Packet8cf& x)
+{
+  return Packet8cf(_mm512_permute_ps(x.v, 0xb1));
+}
+
+
+//---------- double ----------
+struct Packet4cd
+{
+  EIGEN_STRONG_INLINE Packet4cd() {}
+  EIGEN_STRONG_INLINE explicit Packet4cd(const __m512d& a) : v(a) {}
+  __m512d  v;
+};
+
+template<> struct packet_traits<std::complex<double> >  : default_packet_traits
+{
+  typedef Packet4cd type;
+  enum {
+    Vectorizable = 1,
+    AlignedOnScalar = 0,
+    size = 4,
+
+    HasAdd    = 1,
+    HasSub    = 1,
+    HasMul    = 1,
+    HasDiv    = 1,
+    HasNegate = 1,
+    HasAbs    = 0,
+    HasAbs2   = 0,
+    HasMin    = 0,
+    HasMax    = 0,
+    HasSetLinear = 0,
+    HasMasks  = 1
+  };
+};
+
+template<> struct unpacket_traits<Packet4cd> { typedef std::complex<double> type; enum {size=4}; };
+
+EIGEN_STRONG_INLINE Packet2cd plower_half(const Packet4cd& a) { return Packet2cd(plower_half(a.v)); }
+EIGEN_STRONG_INLINE Packet2cd pupper_half(const Packet4cd& a) { return Packet2cd(pupper_half(a.v)); }
+EIGEN_STRONG_INLINE Packet4cd pcombine_halves(const Packet2cd& lower, const Packet2cd& upper)
+{ return Packet4cd(pcombine_halves(lower.v, upper.v)); }
+
+template<> EIGEN_STRONG_INLINE Packet4cd padd<Packet4cd>(const Packet4cd& a, const Packet4cd& b) { return Packet4cd(_mm512_add_pd(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet4cd psub<Packet4cd>(const Packet4cd& a, const Packet4cd& b) { return Packet4cd(_mm512_sub_pd(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet4cd pnegate(const Packet4cd& a) { return Packet4cd(pnegate(a.v)); }
+template<> EIGEN_STRONG_INLINE Packet4cd pconj(const Packet4cd& a)
+{
+  return Packet4cd(pxor(a.v, _mm512_setr_pd(0.0,-0.0,0.0,-0.0,0.0,-0.0,0.0,-0.0)));
+}
+
+template<> EIGEN_STRONG_INLINE Packet4cd pmul<Packet4cd>(const Packet4cd& a, const Packet4cd& b)
+{
+  return Packet4cd(_mm512_fmaddsub_pd(_mm512_movedup_pd(a.v), b.v,
+                                      _mm512_mul_pd(_mm512_permute_pd(a.v, 0xff),
+                                                    _mm512_permute_pd(b.v, 0x55))));
+}
+
+template<> EIGEN_STRONG_INLINE Packet4cd pand   <Packet4cd>(const Packet4cd& a, const Packet4cd& b) { return Packet4cd(pand(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet4cd por    <Packet4cd>(const Packet4cd& a, const Packet4cd& b) { return Packet4cd(por(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet4cd pxor   <Packet4cd>(const Packet4cd& a, const Packet4cd& b) { return Packet4cd(pxor(a.v,b.v)); }
+template<> EIGEN_STRONG_INLINE Packet4cd pandnot<Packet4cd>(const Packet4cd& a, const Packet4cd& b) { return Packet4cd(pandnot(a.v,b.v)); }
+
+template<> EIGEN_STRONG_INLINE Packet4cd pload <Packet4cd>(const std::complex<double>* from)
+{ EIGEN_DEBUG_ALIGNED_LOAD return Packet4cd(pload<Packet8d>((const double*)from)); }
+template<> EIGEN_STRONG_INLINE Packet4cd ploadu<Packet4cd>(const std::complex<double>* from)
+{ EIGEN_DEBUG_UNALIGNED_LOAD return Packet4cd(ploadu<Packet8d>((const double*)from)); }
+
+template<> EIGEN_STRONG_INLINE Packet4cd pset1<Packet4cd>(const std::complex<double>& from)
+{
+  return Packet4cd(_mm512_broadcast_f64x4(pset1<Packet2cd>(from).v));
+}
+
+// [a0 a0 a1 a1]
+template<> EIGEN_STRONG_INLINE Packet4cd ploaddup<Packet4cd>(const std::complex<double>* from)
+{
+  return pcombine_halves(pset1<Packet2cd>(from[0]), pset1<Packet2cd>(from[1]));
+}
+
+template<> EIGEN_STRONG_INLINE void pstore <std::complex<double> >(std::complex<double> *   to, const Packet4cd& from) { EIGEN_DEBUG_ALIGNED_STORE pstore((double*)to, from.v); }
+template<> EIGEN_STRONG_INLINE void pstoreu<std::complex<double> >(std::complex<double> *   to, const Packet4cd& from) { EIGEN_DEBUG_UNALIGNED_STORE pstoreu((double*)to, from.v); }
+
+template<> EIGEN_STRONG_INLINE Packet4cd pblend<Packet4cd>(const Packet4cd& a, const Packet4cd& b, DenseIndex split)
+{
+  return Packet4cd(pblend(a.v, b.v, 2*split));
+}
+template<> EIGEN_STRONG_INLINE void pstoreu_masked<std::complex<double> >(std::complex<double>* to, const Packet4cd& from, DenseIndex begin, DenseIndex end)
+{
+  pstoreu_masked((double*)to, from.v, 2*begin, 2*end);
+}
+
+template<> EIGEN_STRONG_INLINE std::complex<double>  pfirst<Packet4cd>(const Packet4cd& a)
+{
+  return pfirst(Packet1cd(_mm512_castpd512_pd128(a.v)));
+}
+
+template<> EIGEN_STRONG_INLINE Packet4cd preverse(const Packet4cd& a)
+{
+  return Packet4cd(_mm512_permutexvar_pd(_mm512_set_epi64(1,0,3,2,5,4,7,6), a.v));
+}
+
+template<> EIGEN_STRONG_INLINE std::complex<double> predux<Packet4cd>(const Packet4cd& a)
+{
+  return predux(padd(plower_half(a), pupper_half(a)));
+}
+
+template<> EIGEN_STRONG_INLINE Packet4cd preduxp<Packet4cd>(const Packet4cd* vecs)
+{
+  Packet2cd halves[4];
+  for(int i = 0; i < 4; ++i)
+    halves[i] = padd(plower_half(vecs[i]), pupper_half(vecs[i]));
+  return pcombine_halves(preduxp(halves), preduxp(halves+2));
+}
+
+template<> EIGEN_STRONG_INLINE std::complex<double> predux_mul<Packet4cd>(const Packet4cd& a)
+{
+  return predux_mul(pmul(plower_half(a), pupper_half(a)));
+}
+
+template<int Offset>
+struct palign_impl<Offset,Packet4cd>
+{
+  static EIGEN_STRONG_INLINE void run(Packet4cd& first, const Packet4cd& second)
+  {
+    palign_impl<2*Offset,Packet8d>::run(first.v, second.v);
+  }
+};
+
+template<> struct conj_helper<Packet4cd, Packet4cd, false,true>
+{
+  EIGEN_STRONG_INLINE Packet4cd pmadd(const Packet4cd& x, const Packet4cd& y, const Packet4cd& c) const
+  { return padd(pmul(x,y),c); }
+
+  EIGEN_STRONG_INLINE Packet4cd pmul(const Packet4cd& a, const Packet4cd& b) const
+  {
+    return internal::pmul(a, pconj(b));
+  }
+};
+
+template<> struct conj_helper<Packet4cd, Packet4cd, true,false>
+{
+  EIGEN_STRONG_INLINE Packet4cd pmadd(const Packet4cd& x, const Packet4cd& y, const Packet4cd& c) const
+  { return padd(pmul(x,y),c); }
+
+  EIGEN_STRONG_INLINE Packet4cd pmul(const Packet4cd& a, const Packet4cd& b) const
+  {
+    return internal::pmul(pconj(a), b);
+  }
+};
+
+template<> struct conj_helper<Packet4cd, Packet4cd, true,true>
+{
+  EIGEN_STRONG_INLINE Packet4cd pmadd(const Packet4cd& x, const Packet4cd& y, const Packet4cd& c) const
+  { return padd(pmul(x,y),c); }
+
+  EIGEN_STRONG_INLINE Packet4cd pmul(const Packet4cd& a, const Packet4cd& b) const
+  {
+    return pconj(internal::pmul(a, b));
+  }
+};
+
+template<> struct conj_helper<Packet8d, Packet4cd, false,false>
+{
+  EIGEN_STRONG_INLINE Packet4cd pmadd(const Packet8d& x, const Packet4cd& y, const Packet4cd& c) const
+  { return padd(c, pmul(x,y)); }
+
+  EIGEN_STRONG_INLINE Packet4cd pmul(const Packet8d& x, const Packet4cd& y) const
+  { return Packet4cd(Eigen::internal::pmul(x, y.v)); }
+};
+
+template<> struct conj_helper<Packet4cd, Packet8d, false,false>
+{
+  EIGEN_STRONG_INLINE Packet4cd pmadd(const Packet4cd& x, const Packet8d& y, const Packet4cd& c) const
+  { return padd(c, pmul(x,y)); }
+
+  EIGEN_STRONG_INLINE Packet4cd pmul(const Packet4cd& x, const Packet8d& y) const
+  { return Packet4cd(Eigen::internal::pmul(x.v, y)); }
+};
+
+template<> EIGEN_STRONG_INLINE Packet4cd pdiv<Packet4cd>(const Packet4cd& a, const Packet4cd& b)
+{
+  Packet4cd res = conj_helper<Packet4cd,Packet4cd,false,true>().pmul(a,b);
+  __m512d s = _mm512_mul_pd(b.v,b.v);
+  return Packet4cd(_mm512_div_pd(res.v, _mm512_add_pd(s,_mm512_permute_pd(s, 0x55))));
+}
+
+EIGEN_STRONG_INLINE Packet4cd pcplxflip/*<Packet4cd>*/(const Packet4cd& x)
+{
+  return Packet4cd(_mm512_permute_pd(x.v, 0x55));
+}
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_COMPLEX_AVX512_H
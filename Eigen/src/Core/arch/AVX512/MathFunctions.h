@@ -0,0 +1,63 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_MATH_FUNCTIONS_AVX512_H
+#define EIGEN_MATH_FUNCTIONS_AVX512_H
+
+namespace Eigen {
+
+namespace internal {
+
+// The transcendental functions apply the AVX versions to both halves of the packet
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet16f plog<Packet16f>(const Packet16f& x)
+{
+  return pcombine_halves(plog<Packet8f>(plower_half(x)), plog<Packet8f>(pupper_half(x)));
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet16f pexp<Packet16f>(const Packet16f& x)
+{
+  return pcombine_halves(pexp<Packet8f>(plower_half(x)), pexp<Packet8f>(pupper_half(x)));
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet16f psin<Packet16f>(const Packet16f& x)
+{
+  return pcombine_halves(psin<Packet8f>(plower_half(x)), psin<Packet8f>(pupper_half(x)));
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet16f pcos<Packet16f>(const Packet16f& x)
+{
+  return pcombine_halves(pcos<Packet8f>(plower_half(x)), pcos<Packet8f>(pupper_half(x)));
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet8d pexp<Packet8d>(const Packet8d& x)
+{
+  return pcombine_halves(pexp<Packet4d>(plower_half(x)), pexp<Packet4d>(pupper_half(x)));
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet16f psqrt<Packet16f>(const Packet16f& x)
+{
+  return _mm512_sqrt_ps(x);
+}
+
+template<> EIGEN_DEFINE_FUNCTION_ALLOWING_MULTIPLE_DEFINITIONS EIGEN_UNUSED
+Packet8d psqrt<Packet8d>(const Packet8d& x)
+{
+  return _mm512_sqrt_pd(x);
+}
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_MATH_FUNCTIONS_AVX512_H
@@ -0,0 +1,289 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_PACKET_MATH_AVX512_H
+#define EIGEN_PACKET_MATH_AVX512_H
+
+namespace Eigen {
+
+namespace internal {
+
+// The AVX-512 packets of float and double replace the AVX ones, which are still used
+// to reduce the two 256-bit halves of a packet and for the transcendental functions.
+// Only AVX512F instructions are used.
+//
+// As with AVX, the aligned loads and stores are performed with the unaligned instructions
+// since Eigen only guarantees 16-byte alignment.
+//
+// The mask registers give pblend() and pstoreu_masked() a single instruction, hence HasMasks:
+// the assignments, reductions and matrix-vector products process their first and last
+// incomplete packets with masks instead of scalar loops.
+
+typedef __m512  Packet16f;
+typedef __m512d Packet8d;
+
+template<> struct is_arithmetic<__m512>  { enum { value = true }; };
+template<> struct is_arithmetic<__m512d> { enum { value = true }; };
+
+// AVX512F has its own fused multiply-add
+#ifndef EIGEN_HAS_SINGLE_INSTRUCTION_MADD
+#define EIGEN_HAS_SINGLE_INSTRUCTION_MADD
+#endif
+
+template<> struct packet_traits<float>  : default_packet_traits
+{
+  typedef Packet16f type;
+  enum {
+    Vectorizable = 1,
+    AlignedOnScalar = 1,
+    size=16,
+
+    HasMasks = 1,
+    HasDiv  = 1,
+    HasSin  = EIGEN_FAST_MATH,
+    HasCos  = EIGEN_FAST_MATH,
+    HasLog  = 1,
+    HasExp  = 1,
+    HasSqrt = 1
+  };
+};
+template<> struct packet_traits<double> : default_packet_traits
+{
+  typedef Packet8d type;
+  enum {
+    Vectorizable = 1,
+    AlignedOnScalar = 1,
+    size=8,
+
+    HasMasks = 1,
+    HasDiv  = 1,
+    HasExp  = 1,
+    HasSqrt = 1
+  };
+};
+
+template<> struct unpacket_traits<Packet16f> { typedef float  type; enum {size=16}; };
+template<> struct unpacket_traits<Packet8d>  { typedef double type; enum {size=8}; };
+
+// The 256-bit halves of a packet
+EIGEN_STRONG_INLINE Packet8f plower_half(const Packet16f& a) { return _mm512_castps512_ps256(a); }
+EIGEN_STRONG_INLINE Packet4d plower_half(const Packet8d& a)  { return _mm512_castpd512_pd256(a); }
+EIGEN_STRONG_INLINE Packet8f pupper_half(const Packet16f& a) { return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1)); }
+EIGEN_STRONG_INLINE Packet4d pupper_half(const Packet8d& a)  { return _mm512_extractf64x4_pd(a, 1); }
+
+EIGEN_STRONG_INLINE Packet16f pcombine_halves(const Packet8f& lower, const Packet8f& upper)
+{
+  return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(lower)), _mm256_castps_pd(upper), 1));
+}
+EIGEN_STRONG_INLINE Packet8d pcombine_halves(const Packet4d& lower, const Packet4d& upper)
+{
+  return _mm512_insertf64x4(_mm512_castpd256_pd512(lower), upper, 1);
+}
+
+template<> EIGEN_STRONG_INLINE Packet16f pset1<Packet16f>(const float&  from) { return _mm512_set1_ps(from); }
+template<> EIGEN_STRONG_INLINE Packet8d  pset1<Packet8d>(const double&  from) { return _mm512_set1_pd(from); }
+
+template<> EIGEN_STRONG_INLINE Packet16f plset<float>(const float& a)
+{
+  return _mm512_add_ps(pset1<Packet16f>(a), _mm512_set_ps(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0));
+}
+template<> EIGEN_STRONG_INLINE Packet8d plset<double>(const double& a)
+{
+  return _mm512_add_pd(pset1<Packet8d>(a), _mm512_set_pd(7,6,5,4,3,2,1,0));
+}
+
+template<> EIGEN_STRONG_INLINE Packet16f padd<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_add_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet8d  padd<Packet8d>(const Packet8d& a, const Packet8d& b)     { return _mm512_add_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet16f psub<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_sub_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet8d  psub<Packet8d>(const Packet8d& a, const Packet8d& b)     { return _mm512_sub_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pmul<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_mul_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet8d  pmul<Packet8d>(const Packet8d& a, const Packet8d& b)     { return _mm512_mul_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pdiv<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_div_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet8d  pdiv<Packet8d>(const Packet8d& a, const Packet8d& b)     { return _mm512_div_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pmadd(const Packet16f& a, const Packet16f& b, const Packet16f& c) { return _mm512_fmadd_ps(a,b,c); }
+template<> EIGEN_STRONG_INLINE Packet8d  pmadd(const Packet8d& a, const Packet8d& b, const Packet8d& c)    { return _mm512_fmadd_pd(a,b,c); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pmin<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_min_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet8d  pmin<Packet8d>(const Packet8d& a, const Packet8d& b)     { return _mm512_min_pd(a,b); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pmax<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_max_ps(a,b); }
+template<> EIGEN_STRONG_INLINE Packet8d  pmax<Packet8d>(const Packet8d& a, const Packet8d& b)     { return _mm512_max_pd(a,b); }
+
+// the floating point bitwise operations need AVX512DQ, hence the integer ones
+template<> EIGEN_STRONG_INLINE Packet16f pand<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a),_mm512_castps_si512(b))); }
+template<> EIGEN_STRONG_INLINE Packet8d  pand<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a),_mm512_castpd_si512(b))); }
+
+template<> EIGEN_STRONG_INLINE Packet16f por<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a),_mm512_castps_si512(b))); }
+template<> EIGEN_STRONG_INLINE Packet8d  por<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(a),_mm512_castpd_si512(b))); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pxor<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a),_mm512_castps_si512(b))); }
+template<> EIGEN_STRONG_INLINE Packet8d  pxor<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a),_mm512_castpd_si512(b))); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pandnot<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_andnot_si512(_mm512_castps_si512(a),_mm512_castps_si512(b))); }
+template<> EIGEN_STRONG_INLINE Packet8d  pandnot<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_andnot_si512(_mm512_castpd_si512(a),_mm512_castpd_si512(b))); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pnegate(const Packet16f& a) { return pxor(a, _mm512_set1_ps(-0.0f)); }
+template<> EIGEN_STRONG_INLINE Packet8d  pnegate(const Packet8d& a)  { return pxor(a, _mm512_set1_pd(-0.0)); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pabs(const Packet16f& a) { return pandnot(_mm512_set1_ps(-0.0f), a); }
+template<> EIGEN_STRONG_INLINE Packet8d  pabs(const Packet8d& a)  { return pandnot(_mm512_set1_pd(-0.0), a); }
+
+// see the note at the top of the file about alignment
+template<> EIGEN_STRONG_INLINE Packet16f pload<Packet16f>(const float* from) { EIGEN_DEBUG_ALIGNED_LOAD return _mm512_loadu_ps(from); }
+template<> EIGEN_STRONG_INLINE Packet8d  pload<Packet8d>(const double* from) { EIGEN_DEBUG_ALIGNED_LOAD return _mm512_loadu_pd(from); }
+
+template<> EIGEN_STRONG_INLINE Packet16f ploadu<Packet16f>(const float* from) { EIGEN_DEBUG_UNALIGNED_LOAD return _mm512_loadu_ps(from); }
+template<> EIGEN_STRONG_INLINE Packet8d  ploadu<Packet8d>(const double* from) { EIGEN_DEBUG_UNALIGNED_LOAD return _mm512_loadu_pd(from); }
+
+// [a0 a0 a1 a1 ... a7 a7]
+template<> EIGEN_STRONG_INLINE Packet16f ploaddup<Packet16f>(const float* from)
+{
+  return _mm512_permutexvar_ps(_mm512_set_epi32(7,7,6,6,5,5,4,4,3,3,2,2,1,1,0,0),
+                               _mm512_castps256_ps512(_mm256_loadu_ps(from)));
+}
+// [a0 a0 a1 a1 a2 a2 a3 a3]
+template<> EIGEN_STRONG_INLINE Packet8d ploaddup<Packet8d>(const double* from)
+{
+  return _mm512_permutexvar_pd(_mm512_set_epi64(3,3,2,2,1,1,0,0),
+                               _mm512_castpd256_pd512(_mm256_loadu_pd(from)));
+}
+
+template<> EIGEN_STRONG_INLINE void pstore<float>(float*   to, const Packet16f& from) { EIGEN_DEBUG_ALIGNED_STORE _mm512_storeu_ps(to, from); }
+template<> EIGEN_STRONG_INLINE void pstore<double>(double* to, const Packet8d& from)  { EIGEN_DEBUG_ALIGNED_STORE _mm512_storeu_pd(to, from); }
+
+template<> EIGEN_STRONG_INLINE void pstoreu<float>(float*   to, const Packet16f& from) { EIGEN_DEBUG_UNALIGNED_STORE _mm512_storeu_ps(to, from); }
+template<> EIGEN_STRONG_INLINE void pstoreu<double>(double* to, const Packet8d& from)  { EIGEN_DEBUG_UNALIGNED_STORE _mm512_storeu_pd(to, from); }
+
+template<> EIGEN_STRONG_INLINE Packet16f pgather<Packet16f,float,int>(const float* from, const int* indices)
+{
+  return _mm512_i32gather_ps(_mm512_loadu_si512(indices), from, 4);
+}
+template<> EIGEN_STRONG_INLINE Packet8d pgather<Packet8d,double,int>(const double* from, const int* indices)
+{
+  return _mm512_i32gather_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), from, 8);
+}
+
+template<> EIGEN_STRONG_INLINE Packet16f pblend<Packet16f>(const Packet16f& a, const Packet16f& b, DenseIndex split)
+{
+  return _mm512_mask_blend_ps(__mmask16(0xffffu << split), a, b);
+}
+template<> EIGEN_STRONG_INLINE Packet8d pblend<Packet8d>(const Packet8d& a, const Packet8d& b, DenseIndex split)
+{
+  return _mm512_mask_blend_pd(__mmask8(0xffu << split), a, b);
+}
+
+template<> EIGEN_STRONG_INLINE void pstoreu_masked<float>(float* to, const Packet16f& from, DenseIndex begin, DenseIndex end)
+{
+  EIGEN_DEBUG_UNALIGNED_STORE _mm512_mask_storeu_ps(to, __mmask16((1u << end) - (1u << begin)), from);
+}
+template<> EIGEN_STRONG_INLINE void pstoreu_masked<double>(double* to, const Packet8d& from, DenseIndex begin, DenseIndex end)
+{
+  EIGEN_DEBUG_UNALIGNED_STORE _mm512_mask_storeu_pd(to, __mmask8((1u << end) - (1u << begin)), from);
+}
+
+template<> EIGEN_STRONG_INLINE float  pfirst<Packet16f>(const Packet16f& a) { return _mm_cvtss_f32(_mm512_castps512_ps128(a)); }
+template<> EIGEN_STRONG_INLINE double pfirst<Packet8d>(const Packet8d& a)    { return _mm_cvtsd_f64(_mm512_castpd512_pd128(a)); }
+
+template<> EIGEN_STRONG_INLINE Packet16f preverse(const Packet16f& a)
+{
+  return _mm512_permutexvar_ps(_mm512_set_epi32(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15), a);
+}
+template<> EIGEN_STRONG_INLINE Packet8d preverse(const Packet8d& a)
+{
+  return _mm512_permutexvar_pd(_mm512_set_epi64(0,1,2,3,4,5,6,7), a);
+}
+
+// The reductions combine the two halves and finish with the AVX versions
+template<> EIGEN_STRONG_INLINE float predux<Packet16f>(const Packet16f& a)
+{
+  return predux(padd(plower_half(a), pupper_half(a)));
+}
+template<> EIGEN_STRONG_INLINE double predux<Packet8d>(const Packet8d& a)
+{
+  return predux(padd(plower_half(a), pupper_half(a)));
+}
+
+template<> EIGEN_STRONG_INLINE Packet16f preduxp<Packet16f>(const Packet16f* vecs)
+{
+  Packet8f halves[16];
+  for(int i = 0; i < 16; ++i)
+    halves[i] = padd(plower_half(vecs[i]), pupper_half(vecs[i]));
+  return pcombine_halves(preduxp(halves), preduxp(halves+8));
+}
+template<> EIGEN_STRONG_INLINE Packet8d preduxp<Packet8d>(const Packet8d* vecs)
+{
+  Packet4d halves[8];
+  for(int i = 0; i < 8; ++i)
+    halves[i] = padd(plower_half(vecs[i]), pupper_half(vecs[i]));
+  return pcombine_halves(preduxp(halves), preduxp(halves+4));
+}
+
+template<> EIGEN_STRONG_INLINE float predux_mul<Packet16f>(const Packet16f& a)
+{
+  return predux_mul(pmul(plower_half(a), pupper_half(a)));
+}
+template<> EIGEN_STRONG_INLINE double predux_mul<Packet8d>(const Packet8d& a)
+{
+  return predux_mul(pmul(plower_half(a), pupper_half(a)));
+}
+
+template<> EIGEN_STRONG_INLINE float predux_min<Packet16f>(const Packet16f& a)
+{
+  return predux_min(pmin(plower_half(a), pupper_half(a)));
+}
+template<> EIGEN_STRONG_INLINE double predux_min<Packet8d>(const Packet8d& a)
+{
+  return predux_min(pmin(plower_half(a), pupper_half(a)));
+}
+
+template<> EIGEN_STRONG_INLINE float predux_max<Packet16f>(const Packet16f& a)
+{
+  return predux_max(pmax(plower_half(a), pupper_half(a)));
+}
+template<> EIGEN_STRONG_INLINE double predux_max<Packet8d>(const Packet8d& a)
+{
+  return predux_max(pmax(plower_half(a), pupper_half(a)));
+}
+
+// valignd/valignq shift the concatenation of two registers by whole elements
+template<int Offset>
+struct palign_impl<Offset,Packet16f>
+{
+  static EIGEN_STRONG_INLINE void run(Packet16f& first, const Packet16f& second)
+  {
+    if (Offset!=0)
+      first = _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(second), _mm512_castps_si512(first), Offset));
+  }
+};
+
+template<int Offset>
+struct palign_impl<Offset,Packet8d>
+{
+  static EIGEN_STRONG_INLINE void run(Packet8d& first, const Packet8d& second)
+  {
+    if (Offset!=0)
+      first = _mm512_castsi512_pd(_mm512_alignr_epi64(_mm512_castpd_si512(second), _mm512_castpd_si512(first), Offset));
+  }
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_PACKET_MATH_AVX512_H
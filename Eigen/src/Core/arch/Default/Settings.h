@@ -39,6 +39,43 @@
 #endif
 
 
+/** Defines the size in bytes from which filling a contiguous object with a constant (setZero(),
+  * setConstant(), Zero(), Constant()) is split among the threads, so that the pages of a large
+  * matrix are first touched, and placed on their NUMA node, by several threads.
+  */
+#ifndef EIGEN_PARALLEL_FILL_THRESHOLD
+#define EIGEN_PARALLEL_FILL_THRESHOLD (1<<22)
+#endif
+
+/** Defines the size in bytes of the matrix from which a general matrix * vector product is split
+  * among the threads, by panels of rows of the matrix. For a selfadjoint matrix * vector product,
+  * the size of the stored triangle is used.
+  */
+#ifndef EIGEN_PARALLEL_GEMV_THRESHOLD
+#define EIGEN_PARALLEL_GEMV_THRESHOLD (1<<20)
+#endif
+
+/** Defines the number of nonzeros (times the number of columns of the dense operand) a thread has
+  * to process at least when a sparse * dense product is split among the threads.
+  */
+#ifndef EIGEN_PARALLEL_SPMV_THRESHOLD
+#define EIGEN_PARALLEL_SPMV_THRESHOLD 16384
+#endif
+
+/** Defines the number of triplets a thread has to process at least when SparseMatrix::setFromTriplets()
+  * counts, scatters and combines a random access range of triplets among the threads.
+  */
+#ifndef EIGEN_PARALLEL_TRIPLETS_THRESHOLD
+#define EIGEN_PARALLEL_TRIPLETS_THRESHOLD 65536
+#endif
+
+/** Defines the number of nonzeros of both operands a thread has to process at least when a conservative
+  * sparse * sparse product is split among the threads.
+  */
+#ifndef EIGEN_PARALLEL_SPGEMM_THRESHOLD
+#define EIGEN_PARALLEL_SPGEMM_THRESHOLD 32768
+#endif
+
 /** Defines the default number of registers available for that architecture.
   * Currently it must be 8 or 16. Other values will fail.
   */
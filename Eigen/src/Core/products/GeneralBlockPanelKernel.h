@@ -160,7 +160,7 @@ public:
     
     NumberOfRegisters = EIGEN_ARCH_DEFAULT_NUMBER_OF_REGISTERS,
 
-    // register block size along the N direction (must be either 2 or 4)
+    // register block size along the N direction (must be 2, 4 or 8)
     nr = NumberOfRegisters/4,
 
     // register block size along the M direction (currently, this one cannot be modified)
@@ -205,7 +205,12 @@ public:
 
   EIGEN_STRONG_INLINE void madd(const LhsPacket& a, const RhsPacket& b, AccPacket& c, AccPacket& tmp) const
   {
+#ifdef EIGEN_HAS_SINGLE_INSTRUCTION_MADD
+    EIGEN_UNUSED_VARIABLE(tmp);
+    c = pmadd(a,b,c);
+#else
     tmp = b; tmp = pmul(a,tmp); c = padd(c,tmp);
+#endif
   }
 
   EIGEN_STRONG_INLINE void acc(const AccPacket& c, const ResPacket& alpha, ResPacket& r) const
@@ -281,7 +286,12 @@ public:
 
   EIGEN_STRONG_INLINE void madd_impl(const LhsPacket& a, const RhsPacket& b, AccPacket& c, RhsPacket& tmp, const true_type&) const
   {
+#ifdef EIGEN_HAS_SINGLE_INSTRUCTION_MADD
+    EIGEN_UNUSED_VARIABLE(tmp);
+    c.v = pmadd(a.v,b,c.v);
+#else
     tmp = b; tmp = pmul(a.v,tmp); c.v = padd(c.v,tmp);
+#endif
   }
 
   EIGEN_STRONG_INLINE void madd_impl(const LhsScalar& a, const RhsScalar& b, ResScalar& c, RhsScalar& /*tmp*/, const false_type&) const
@@ -378,8 +388,13 @@ public:
 
   EIGEN_STRONG_INLINE void madd(const LhsPacket& a, const RhsPacket& b, DoublePacket& c, RhsPacket& /*tmp*/) const
   {
+#ifdef EIGEN_HAS_SINGLE_INSTRUCTION_MADD
+    c.first   = pmadd(a,b.first, c.first);
+    c.second  = pmadd(a,b.second,c.second);
+#else
     c.first   = padd(pmul(a,b.first), c.first);
     c.second  = padd(pmul(a,b.second),c.second);
+#endif
   }
 
   EIGEN_STRONG_INLINE void madd(const LhsPacket& a, const RhsPacket& b, ResPacket& c, RhsPacket& /*tmp*/) const
@@ -486,7 +501,12 @@ public:
 
   EIGEN_STRONG_INLINE void madd_impl(const LhsPacket& a, const RhsPacket& b, AccPacket& c, RhsPacket& tmp, const true_type&) const
   {
+#ifdef EIGEN_HAS_SINGLE_INSTRUCTION_MADD
+    EIGEN_UNUSED_VARIABLE(tmp);
+    c.v = pmadd(a,b.v,c.v);
+#else
     tmp = b; tmp.v = pmul(a,tmp.v); c = padd(c,tmp);
+#endif
   }
 
   EIGEN_STRONG_INLINE void madd_impl(const LhsScalar& a, const RhsScalar& b, ResScalar& c, RhsScalar& /*tmp*/, const false_type&) const
@@ -551,6 +571,13 @@ struct gebp_kernel
     {
       traits.unpackRhs(depth*nr,&blockB[j2*strideB+offsetB*nr],unpackedB); 
 
+      if(nr==8)
+      {
+        panel8(traits, &res[j2*resStride], resStride, blockA, unpackedB, &blockB[j2*strideB+offsetB*nr],
+               rows, depth, alpha, strideA, offsetA);
+        continue;
+      }
+
       // loops on each largest micro horizontal panel of lhs (mr x depth)
       // => we select a mr x nr micro block of res which is entirely
       //    stored into mr/packet_size x nr registers.
@@ -1089,6 +1116,148 @@ EIGEN_ASM_COMMENT("mybegin4");
       }
     }
   }
+
+  // With 32 registers (AVX-512) the rhs is processed by panels of 8 columns: a mr x 8 block of
+  // res is kept in 16 registers, then a LhsProgress x 8 block in 8, and the remaining rows are
+  // processed one at a time. "unpackedB" holds the panel unpacked, "blockB" the packed one.
+  EIGEN_STRONG_INLINE void panel8(Traits& traits, ResScalar* res, Index resStride, const LhsScalar* blockA,
+                                  const RhsScalar* unpackedB, const RhsScalar* blockB, Index rows, Index depth,
+                                  ResScalar alpha, Index strideA, Index offsetA)
+  {
+    conj_helper<LhsScalar,RhsScalar,ConjugateLhs,ConjugateRhs> cj;
+    const Index peeled_mc = (rows/mr)*mr;
+    const Index peeled_mc2 = peeled_mc + (rows-peeled_mc >= LhsProgress ? LhsProgress : 0);
+    const ResPacket alphav = pset1<ResPacket>(alpha);
+
+    for(Index i=0; i<peeled_mc; i+=mr)
+    {
+      const LhsScalar* blA = &blockA[i*strideA+offsetA*mr];
+      prefetch(&blA[0]);
+
+      // C<j> and D<j> hold the two packets of the j-th column of the res block
+      AccPacket C0, C1, C2, C3, C4, C5, C6, C7, D0, D1, D2, D3, D4, D5, D6, D7;
+      traits.initAcc(C0); traits.initAcc(C1); traits.initAcc(C2); traits.initAcc(C3);
+      traits.initAcc(C4); traits.initAcc(C5); traits.initAcc(C6); traits.initAcc(C7);
+      traits.initAcc(D0); traits.initAcc(D1); traits.initAcc(D2); traits.initAcc(D3);
+      traits.initAcc(D4); traits.initAcc(D5); traits.initAcc(D6); traits.initAcc(D7);
+
+      const RhsScalar* blB = unpackedB;
+      for(Index k=0; k<depth; k++)
+      {
+        LhsPacket A0, A1;
+        RhsPacket B_0, T0;
+
+        traits.loadLhs(&blA[0*LhsProgress], A0);
+        traits.loadLhs(&blA[1*LhsProgress], A1);
+        traits.loadRhs(&blB[0*RhsProgress], B_0); traits.madd(A0,B_0,C0,T0); traits.madd(A1,B_0,D0,B_0);
+        traits.loadRhs(&blB[1*RhsProgress], B_0); traits.madd(A0,B_0,C1,T0); traits.madd(A1,B_0,D1,B_0);
+        traits.loadRhs(&blB[2*RhsProgress], B_0); traits.madd(A0,B_0,C2,T0); traits.madd(A1,B_0,D2,B_0);
+        traits.loadRhs(&blB[3*RhsProgress], B_0); traits.madd(A0,B_0,C3,T0); traits.madd(A1,B_0,D3,B_0);
+        traits.loadRhs(&blB[4*RhsProgress], B_0); traits.madd(A0,B_0,C4,T0); traits.madd(A1,B_0,D4,B_0);
+        traits.loadRhs(&blB[5*RhsProgress], B_0); traits.madd(A0,B_0,C5,T0); traits.madd(A1,B_0,D5,B_0);
+        traits.loadRhs(&blB[6*RhsProgress], B_0); traits.madd(A0,B_0,C6,T0); traits.madd(A1,B_0,D6,B_0);
+        traits.loadRhs(&blB[7*RhsProgress], B_0); traits.madd(A0,B_0,C7,T0); traits.madd(A1,B_0,D7,B_0);
+
+        blB += 8*RhsProgress;
+        blA += mr;
+      }
+
+      ResScalar* r0 = &res[i];
+      ResPacket R0, R1;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C0, alphav, R0); traits.acc(D0, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C1, alphav, R0); traits.acc(D1, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C2, alphav, R0); traits.acc(D2, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C3, alphav, R0); traits.acc(D3, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C4, alphav, R0); traits.acc(D4, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C5, alphav, R0); traits.acc(D5, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C6, alphav, R0); traits.acc(D6, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); R1 = ploadu<ResPacket>(r0+ResPacketSize);
+      traits.acc(C7, alphav, R0); traits.acc(D7, alphav, R1); pstoreu(r0, R0); pstoreu(r0+ResPacketSize, R1);
+    }
+
+    if(rows-peeled_mc>=LhsProgress)
+    {
+      Index i = peeled_mc;
+      const LhsScalar* blA = &blockA[i*strideA+offsetA*LhsProgress];
+      prefetch(&blA[0]);
+
+      AccPacket C0, C1, C2, C3, C4, C5, C6, C7;
+      traits.initAcc(C0); traits.initAcc(C1); traits.initAcc(C2); traits.initAcc(C3);
+      traits.initAcc(C4); traits.initAcc(C5); traits.initAcc(C6); traits.initAcc(C7);
+
+      const RhsScalar* blB = unpackedB;
+      for(Index k=0; k<depth; k++)
+      {
+        LhsPacket A0;
+        RhsPacket B_0;
+
+        traits.loadLhs(&blA[0], A0);
+        traits.loadRhs(&blB[0*RhsProgress], B_0); traits.madd(A0,B_0,C0,B_0);
+        traits.loadRhs(&blB[1*RhsProgress], B_0); traits.madd(A0,B_0,C1,B_0);
+        traits.loadRhs(&blB[2*RhsProgress], B_0); traits.madd(A0,B_0,C2,B_0);
+        traits.loadRhs(&blB[3*RhsProgress], B_0); traits.madd(A0,B_0,C3,B_0);
+        traits.loadRhs(&blB[4*RhsProgress], B_0); traits.madd(A0,B_0,C4,B_0);
+        traits.loadRhs(&blB[5*RhsProgress], B_0); traits.madd(A0,B_0,C5,B_0);
+        traits.loadRhs(&blB[6*RhsProgress], B_0); traits.madd(A0,B_0,C6,B_0);
+        traits.loadRhs(&blB[7*RhsProgress], B_0); traits.madd(A0,B_0,C7,B_0);
+
+        blB += 8*RhsProgress;
+        blA += LhsProgress;
+      }
+
+      ResScalar* r0 = &res[i];
+      ResPacket R0;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C0, alphav, R0); pstoreu(r0, R0); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C1, alphav, R0); pstoreu(r0, R0); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C2, alphav, R0); pstoreu(r0, R0); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C3, alphav, R0); pstoreu(r0, R0); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C4, alphav, R0); pstoreu(r0, R0); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C5, alphav, R0); pstoreu(r0, R0); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C6, alphav, R0); pstoreu(r0, R0); r0 += resStride;
+      R0 = ploadu<ResPacket>(r0); traits.acc(C7, alphav, R0); pstoreu(r0, R0);
+    }
+
+    for(Index i=peeled_mc2; i<rows; i++)
+    {
+      const LhsScalar* blA = &blockA[i*strideA+offsetA];
+      prefetch(&blA[0]);
+
+      // gets a 1 x 8 res block as registers
+      ResScalar C0(0), C1(0), C2(0), C3(0), C4(0), C5(0), C6(0), C7(0);
+      const RhsScalar* blB = blockB;
+      for(Index k=0; k<depth; k++)
+      {
+        LhsScalar A0 = blA[k];
+        RhsScalar B_0;
+
+        B_0 = blB[0]; MADD(cj,A0,B_0,C0,B_0);
+        B_0 = blB[1]; MADD(cj,A0,B_0,C1,B_0);
+        B_0 = blB[2]; MADD(cj,A0,B_0,C2,B_0);
+        B_0 = blB[3]; MADD(cj,A0,B_0,C3,B_0);
+        B_0 = blB[4]; MADD(cj,A0,B_0,C4,B_0);
+        B_0 = blB[5]; MADD(cj,A0,B_0,C5,B_0);
+        B_0 = blB[6]; MADD(cj,A0,B_0,C6,B_0);
+        B_0 = blB[7]; MADD(cj,A0,B_0,C7,B_0);
+
+        blB += 8;
+      }
+      res[0*resStride + i] += alpha*C0;
+      res[1*resStride + i] += alpha*C1;
+      res[2*resStride + i] += alpha*C2;
+      res[3*resStride + i] += alpha*C3;
+      res[4*resStride + i] += alpha*C4;
+      res[5*resStride + i] += alpha*C5;
+      res[6*resStride + i] += alpha*C6;
+      res[7*resStride + i] += alpha*C7;
+    }
+  }
 };
 
 #undef CJMADD
@@ -1187,7 +1356,7 @@ struct gemm_pack_lhs
 
 // copy a complete panel of the rhs
 // this version is optimized for column major matrices
-// The traversal order is as follow: (nr==4):
+// The traversal order is as follow (nr==4, nr==8 interleaves 8 columns the same way):
 //  0  1  2  3   12 13 14 15   24 27
 //  4  5  6  7   16 17 18 19   25 28
 //  8  9 10 11   20 21 22 23   26 29
@@ -1213,12 +1382,20 @@ struct gemm_pack_rhs<Scalar, Index, nr, ColMajor, Conjugate, PanelMode>
       const Scalar* b1 = &rhs[(j2+1)*rhsStride];
       const Scalar* b2 = &rhs[(j2+2)*rhsStride];
       const Scalar* b3 = &rhs[(j2+3)*rhsStride];
+      const Scalar* b4 = &rhs[(j2+4)*rhsStride];
+      const Scalar* b5 = &rhs[(j2+5)*rhsStride];
+      const Scalar* b6 = &rhs[(j2+6)*rhsStride];
+      const Scalar* b7 = &rhs[(j2+7)*rhsStride];
       for(Index k=0; k<depth; k++)
       {
                   blockB[count+0] = cj(b0[k]);
                   blockB[count+1] = cj(b1[k]);
-        if(nr==4) blockB[count+2] = cj(b2[k]);
-        if(nr==4) blockB[count+3] = cj(b3[k]);
+        if(nr>=4) blockB[count+2] = cj(b2[k]);
+        if(nr>=4) blockB[count+3] = cj(b3[k]);
+        if(nr==8) blockB[count+4] = cj(b4[k]);
+        if(nr==8) blockB[count+5] = cj(b5[k]);
+        if(nr==8) blockB[count+6] = cj(b6[k]);
+        if(nr==8) blockB[count+7] = cj(b7[k]);
         count += nr;
       }
       // skip what we have after
@@ -1262,8 +1439,12 @@ struct gemm_pack_rhs<Scalar, Index, nr, RowMajor, Conjugate, PanelMode>
         const Scalar* b0 = &rhs[k*rhsStride + j2];
                   blockB[count+0] = cj(b0[0]);
                   blockB[count+1] = cj(b0[1]);
-        if(nr==4) blockB[count+2] = cj(b0[2]);
-        if(nr==4) blockB[count+3] = cj(b0[3]);
+        if(nr>=4) blockB[count+2] = cj(b0[2]);
+        if(nr>=4) blockB[count+3] = cj(b0[3]);
+        if(nr==8) blockB[count+4] = cj(b0[4]);
+        if(nr==8) blockB[count+5] = cj(b0[5]);
+        if(nr==8) blockB[count+6] = cj(b0[6]);
+        if(nr==8) blockB[count+7] = cj(b0[7]);
         count += nr;
       }
       // skip what we have after
@@ -37,7 +37,8 @@ enum {
               && int(packet_traits<LhsScalar>::size)==int(packet_traits<RhsScalar>::size),
   LhsPacketSize = Vectorizable ? packet_traits<LhsScalar>::size : 1,
   RhsPacketSize = Vectorizable ? packet_traits<RhsScalar>::size : 1,
-  ResPacketSize = Vectorizable ? packet_traits<ResScalar>::size : 1
+  ResPacketSize = Vectorizable ? packet_traits<ResScalar>::size : 1,
+  MaskedEnds = Vectorizable && packet_traits<LhsScalar>::HasMasks && packet_traits<ResScalar>::HasMasks
 };
 
 typedef typename packet_traits<LhsScalar>::type  _LhsPacket;
@@ -71,6 +72,16 @@ EIGEN_DONT_INLINE static void run(
           padd(pcj.pmul(EIGEN_CAT(ploa , A2)<LhsPacket>(&lhs2[j]),    ptmp2), \
                   pcj.pmul(EIGEN_CAT(ploa , A13)<LhsPacket>(&lhs3[j]),   ptmp3)) )))
 
+  // updates the coeffs BEGIN to END-1 of the unaligned packet of res starting at J
+  #define _EIGEN_ACCUMULATE_MASKED_PACKETS(J,BEGIN,END) \
+    pstoreu_masked(&res[J], \
+      padd(ploadu<ResPacket>(&res[J]), \
+        padd( \
+          padd(pcj.pmul(ploadu<LhsPacket>(&lhs0[J]), ptmp0), \
+                  pcj.pmul(ploadu<LhsPacket>(&lhs1[J]), ptmp1)), \
+          padd(pcj.pmul(ploadu<LhsPacket>(&lhs2[J]), ptmp2), \
+                  pcj.pmul(ploadu<LhsPacket>(&lhs3[J]), ptmp3)) )), BEGIN, END)
+
   conj_helper<LhsScalar,RhsScalar,ConjugateLhs,ConjugateRhs> cj;
   conj_helper<LhsPacket,RhsPacket,ConjugateLhs,ConjugateRhs> pcj;
   if(ConjugateRhs)
@@ -137,6 +148,10 @@ EIGEN_DONT_INLINE static void run(
     alignmentPattern = AllAligned;
   }
 
+  // with masks, the unaligned head and tail of the result are processed as full overlapping packets
+  const bool maskedEnds = MaskedEnds && size>=ResPacketSize && size-alignedSize<ResPacketSize;
+  const Index tailStart = size-ResPacketSize;
+
   Index offset1 = (FirstAligned && alignmentStep==1?3:1);
   Index offset3 = (FirstAligned && alignmentStep==1?1:3);
 
@@ -156,6 +171,12 @@ EIGEN_DONT_INLINE static void run(
     {
       /* explicit vectorization */
       // process initial unaligned coeffs
+      if (maskedEnds)
+      {
+        if (alignedStart>0)
+          _EIGEN_ACCUMULATE_MASKED_PACKETS(0, 0, alignedStart);
+      }
+      else
       for (Index j=0; j<alignedStart; ++j)
       {
         res[j] = cj.pmadd(lhs0[j], pfirst(ptmp0), res[j]);
@@ -225,6 +246,12 @@ EIGEN_DONT_INLINE static void run(
     } // end explicit vectorization
 
     /* process remaining coeffs (or all if there is no explicit vectorization) */
+    if (maskedEnds)
+    {
+      if (alignedSize<size)
+        _EIGEN_ACCUMULATE_MASKED_PACKETS(tailStart, alignedSize-tailStart, ResPacketSize);
+    }
+    else
     for (Index j=alignedSize; j<size; ++j)
     {
       res[j] = cj.pmadd(lhs0[j], pfirst(ptmp0), res[j]);
@@ -248,6 +275,12 @@ EIGEN_DONT_INLINE static void run(
       {
         /* explicit vectorization */
         // process first unaligned result's coeffs
+        if (maskedEnds)
+        {
+          if (alignedStart>0)
+            pstoreu_masked(res, pcj.pmadd(ploadu<LhsPacket>(lhs0), ptmp0, ploadu<ResPacket>(res)), 0, alignedStart);
+        }
+        else
         for (Index j=0; j<alignedStart; ++j)
           res[j] += cj.pmul(lhs0[j], pfirst(ptmp0));
         // process aligned result's coeffs
@@ -260,6 +293,13 @@ EIGEN_DONT_INLINE static void run(
       }
 
       // process remaining scalars (or all if no explicit vectorization)
+      if (maskedEnds)
+      {
+        if (alignedSize<size)
+          pstoreu_masked(&res[tailStart], pcj.pmadd(ploadu<LhsPacket>(&lhs0[tailStart]), ptmp0, ploadu<ResPacket>(&res[tailStart])),
+                         alignedSize-tailStart, ResPacketSize);
+      }
+      else
       for (Index i=alignedSize; i<size; ++i)
         res[i] += cj.pmul(lhs0[i], pfirst(ptmp0));
     }
@@ -273,6 +313,7 @@ EIGEN_DONT_INLINE static void run(
       break;
   } while(Vectorizable);
   #undef _EIGEN_ACCUMULATE_PACKETS
+  #undef _EIGEN_ACCUMULATE_MASKED_PACKETS
 }
 };
 
@@ -296,7 +337,8 @@ enum {
               && int(packet_traits<LhsScalar>::size)==int(packet_traits<RhsScalar>::size),
   LhsPacketSize = Vectorizable ? packet_traits<LhsScalar>::size : 1,
   RhsPacketSize = Vectorizable ? packet_traits<RhsScalar>::size : 1,
-  ResPacketSize = Vectorizable ? packet_traits<ResScalar>::size : 1
+  ResPacketSize = Vectorizable ? packet_traits<ResScalar>::size : 1,
+  MaskedEnds = Vectorizable && packet_traits<LhsScalar>::HasMasks && packet_traits<ResScalar>::HasMasks
 };
 
 typedef typename packet_traits<LhsScalar>::type  _LhsPacket;
@@ -327,6 +369,19 @@ EIGEN_DONT_INLINE static void run(
     ptmp2 = pcj.pmadd(EIGEN_CAT(ploa,A2) <LhsPacket>(&lhs2[j]), b, ptmp2); \
     ptmp3 = pcj.pmadd(EIGEN_CAT(ploa,A13)<LhsPacket>(&lhs3[j]), b, ptmp3); }
 
+  // accumulates the unaligned packet of rhs starting at J into the lanes of the accumulators
+  // before (HEAD) or from (!HEAD) SPLIT
+  #define _EIGEN_ACCUMULATE_MASKED_PACKETS(J,HEAD,SPLIT) {\
+    RhsPacket b = ploadu<RhsPacket>(&rhs[J]); \
+    ResPacket t0 = pcj.pmadd(ploadu<LhsPacket>(&lhs0[J]), b, ptmp0); \
+    ResPacket t1 = pcj.pmadd(ploadu<LhsPacket>(&lhs1[J]), b, ptmp1); \
+    ResPacket t2 = pcj.pmadd(ploadu<LhsPacket>(&lhs2[J]), b, ptmp2); \
+    ResPacket t3 = pcj.pmadd(ploadu<LhsPacket>(&lhs3[J]), b, ptmp3); \
+    ptmp0 = HEAD ? pblend(t0, ptmp0, SPLIT) : pblend(ptmp0, t0, SPLIT); \
+    ptmp1 = HEAD ? pblend(t1, ptmp1, SPLIT) : pblend(ptmp1, t1, SPLIT); \
+    ptmp2 = HEAD ? pblend(t2, ptmp2, SPLIT) : pblend(ptmp2, t2, SPLIT); \
+    ptmp3 = HEAD ? pblend(t3, ptmp3, SPLIT) : pblend(ptmp3, t3, SPLIT); }
+
   conj_helper<LhsScalar,RhsScalar,ConjugateLhs,ConjugateRhs> cj;
   conj_helper<LhsPacket,RhsPacket,ConjugateLhs,ConjugateRhs> pcj;
 
@@ -392,6 +447,10 @@ EIGEN_DONT_INLINE static void run(
     alignmentPattern = AllAligned;
   }
 
+  // with masks, the unaligned head and tail of rhs are processed as full overlapping packets
+  const bool maskedEnds = MaskedEnds && depth>=RhsPacketSize && depth-alignedSize<RhsPacketSize;
+  const Index tailStart = depth-RhsPacketSize;
+
   Index offset1 = (FirstAligned && alignmentStep==1?3:1);
   Index offset3 = (FirstAligned && alignmentStep==1?1:3);
 
@@ -413,6 +472,12 @@ EIGEN_DONT_INLINE static void run(
 
       // process initial unaligned coeffs
       // FIXME this loop get vectorized by the compiler !
+      if (maskedEnds)
+      {
+        if (alignedStart>0)
+          _EIGEN_ACCUMULATE_MASKED_PACKETS(0, true, alignedStart);
+      }
+      else
       for (Index j=0; j<alignedStart; ++j)
       {
         RhsScalar b = rhs[j];
@@ -479,6 +544,11 @@ EIGEN_DONT_INLINE static void run(
               _EIGEN_ACCUMULATE_PACKETS(du,du,du);
             break;
         }
+      }
+      if (maskedEnds && alignedSize<depth)
+        _EIGEN_ACCUMULATE_MASKED_PACKETS(tailStart, false, alignedSize-tailStart);
+      if (alignedSize>alignedStart || maskedEnds)
+      {
         tmp0 += predux(ptmp0);
         tmp1 += predux(ptmp1);
         tmp2 += predux(ptmp2);
@@ -488,6 +558,7 @@ EIGEN_DONT_INLINE static void run(
 
     // process remaining coeffs (or all if no explicit vectorization)
     // FIXME this loop get vectorized by the compiler !
+    if (!maskedEnds)
     for (Index j=alignedSize; j<depth; ++j)
     {
       RhsScalar b = rhs[j];
@@ -512,6 +583,12 @@ EIGEN_DONT_INLINE static void run(
       const LhsScalar* lhs0 = lhs + i*lhsStride;
       // process first unaligned result's coeffs
       // FIXME this loop get vectorized by the compiler !
+      if (maskedEnds)
+      {
+        if (alignedStart>0)
+          ptmp0 = pblend(pcj.pmadd(ploadu<LhsPacket>(lhs0), ploadu<RhsPacket>(rhs), ptmp0), ptmp0, alignedStart);
+      }
+      else
       for (Index j=0; j<alignedStart; ++j)
         tmp0 += cj.pmul(lhs0[j], rhs[j]);
 
@@ -524,11 +601,16 @@ EIGEN_DONT_INLINE static void run(
         else
           for (Index j = alignedStart;j<alignedSize;j+=RhsPacketSize)
             ptmp0 = pcj.pmadd(ploadu<LhsPacket>(&lhs0[j]), pload<RhsPacket>(&rhs[j]), ptmp0);
-        tmp0 += predux(ptmp0);
       }
+      if (maskedEnds && alignedSize<depth)
+        ptmp0 = pblend(ptmp0, pcj.pmadd(ploadu<LhsPacket>(&lhs0[tailStart]), ploadu<RhsPacket>(&rhs[tailStart]), ptmp0),
+                       alignedSize-tailStart);
+      if (alignedSize>alignedStart || maskedEnds)
+        tmp0 += predux(ptmp0);
 
       // process remaining scalars
       // FIXME this loop get vectorized by the compiler !
+      if (!maskedEnds)
       for (Index j=alignedSize; j<depth; ++j)
         tmp0 += cj.pmul(lhs0[j], rhs[j]);
       res[i*resIncr] += alpha*tmp0;
@@ -544,6 +626,76 @@ EIGEN_DONT_INLINE static void run(
   } while(Vectorizable);
 
   #undef _EIGEN_ACCUMULATE_PACKETS
+  #undef _EIGEN_ACCUMULATE_MASKED_PACKETS
+}
+};
+
+/* Multithreaded matrix * vector product:
+ * the rows of the matrix are split into panels, each thread running the
+ * kernel above on its own panel and writing its own range of the result.
+ * When the result is contiguous, the panel boundaries are placed on the 64-byte
+ * boundaries of its actual address, so that two threads never write into the same
+ * cache line. Matrices smaller than EIGEN_PARALLEL_GEMV_THRESHOLD bytes are
+ * processed by the calling thread.
+ */
+template<typename Index, typename LhsScalar, int LhsStorageOrder, bool ConjugateLhs, typename RhsScalar, bool ConjugateRhs>
+struct parallel_matrix_vector_product
+{
+typedef typename scalar_product_traits<LhsScalar, RhsScalar>::ReturnType ResScalar;
+typedef typename conditional<LhsStorageOrder==ColMajor,RhsScalar,ResScalar>::type AlphaScalar;
+typedef general_matrix_vector_product<Index,LhsScalar,LhsStorageOrder,ConjugateLhs,RhsScalar,ConjugateRhs> Kernel;
+
+// Runs the kernel on the rows [first*blockRows-skew, last*blockRows-skew) clamped to [0,rows),
+// where res-skew is the start of the cache line holding res
+struct panel
+{
+  void operator()(Index first, Index last) const
+  {
+    const Index r0 = (std::max)(Index(0), first*blockRows - skew);
+    const Index r1 = (std::min)(last*blockRows - skew, rows);
+    if(r0>=r1)
+      return;
+    Kernel::run(r1-r0, cols,
+                LhsStorageOrder==ColMajor ? lhs + r0 : lhs + r0*lhsStride, lhsStride,
+                rhs, rhsIncr,
+                res + r0*resIncr, resIncr,
+                alpha);
+  }
+
+  Index rows, cols, blockRows, skew;
+  const LhsScalar* lhs; Index lhsStride;
+  const RhsScalar* rhs; Index rhsIncr;
+  ResScalar* res; Index resIncr;
+  AlphaScalar alpha;
+};
+
+static void run(
+  Index rows, Index cols,
+  const LhsScalar* lhs, Index lhsStride,
+  const RhsScalar* rhs, Index rhsIncr,
+  ResScalar* res, Index resIncr,
+  AlphaScalar alpha)
+{
+#if defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_THREAD_POOL)
+  if(double(rows)*double(cols)*double(sizeof(LhsScalar)) >= double(EIGEN_PARALLEL_GEMV_THRESHOLD))
+  {
+    panel func;
+    func.rows = rows; func.cols = cols;
+    func.lhs = lhs; func.lhsStride = lhsStride;
+    func.rhs = rhs; func.rhsIncr = rhsIncr;
+    func.res = res; func.resIncr = resIncr;
+    func.alpha = alpha;
+    // one cache line of the result per block, and at least 32kB of the matrix per thread
+    func.blockRows = (std::max)(Index(1), Index(64/sizeof(ResScalar)));
+    const std::size_t address = reinterpret_cast<std::size_t>(res);
+    func.skew = (resIncr==1 && address%sizeof(ResScalar)==0) ? Index((address%64)/sizeof(ResScalar)) % func.blockRows : 0;
+    const Index blocks = (rows + func.skew + func.blockRows - 1) / func.blockRows;
+    const Index grain = (std::max)(Index(1), Index(32768 / (double(func.blockRows)*double(cols)*double(sizeof(LhsScalar)))));
+    parallel_for(blocks, grain, func);
+    return;
+  }
+#endif
+  Kernel::run(rows, cols, lhs, lhsStride, rhs, rhsIncr, res, resIncr, alpha);
 }
 };
 
@@ -27,7 +27,17 @@ inline void manage_multi_threading(Action action, int* v)
   else if(action==GetAction)
   {
     eigen_internal_assert(v!=0);
-    #ifdef EIGEN_HAS_OPENMP
+    #if defined(EIGEN_HAS_THREAD_POOL)
+    if(m_maxThreads<=0)
+    {
+      // same default as OpenMP: OMP_NUM_THREADS, or one thread per core
+      const char* env = std::getenv("OMP_NUM_THREADS");
+      m_maxThreads = env ? std::atoi(env) : 0;
+      if(m_maxThreads<=0)
+        m_maxThreads = (std::max)(1, int(std::thread::hardware_concurrency()));
+    }
+    *v = m_maxThreads;
+    #elif defined(EIGEN_HAS_OPENMP)
     if(m_maxThreads>0)
       *v = m_maxThreads;
     else
@@ -62,7 +72,8 @@ inline int nbThreads()
   return ret;
 }
 
-/** Sets the max number of threads reserved for Eigen
+/** Sets the max number of threads reserved for Eigen. With EIGEN_USE_THREAD_POOL, the default
+  * is the value of OMP_NUM_THREADS, or the number of hardware threads.
   * \sa nbThreads */
 inline void setNbThreads(int v)
 {
@@ -82,12 +93,144 @@ template<typename Index> struct GemmParallelInfo
   Index rhs_length;
 };
 
+/** \internal \returns the rank of the calling thread among the threads of a parallel GEMM */
+inline int parallel_thread_id()
+{
+#if defined(EIGEN_HAS_THREAD_POOL)
+  return thread_pool::gang_rank();
+#elif defined(EIGEN_HAS_OPENMP)
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+/** \internal \returns the number of threads of the current parallel GEMM */
+inline int parallel_thread_count()
+{
+#if defined(EIGEN_HAS_THREAD_POOL)
+  return thread_pool::gang_size();
+#elif defined(EIGEN_HAS_OPENMP)
+  return omp_get_num_threads();
+#else
+  return 1;
+#endif
+}
+
+/** \internal Atomically decrements a counter shared by the threads of a parallel GEMM */
+inline void parallel_atomic_decrement(int volatile& value)
+{
+#if defined(EIGEN_HAS_THREAD_POOL)
+  #ifdef _MSC_VER
+    _InterlockedDecrement(reinterpret_cast<long volatile*>(&value));
+  #else
+    __sync_fetch_and_sub(&value, 1);
+  #endif
+#elif defined(EIGEN_HAS_OPENMP)
+  #pragma omp atomic
+  --value;
+#else
+  --value;
+#endif
+}
+
+/** \internal \returns the number of threads parallel_for() uses for \a size indices in chunks of
+  * at least \a grain indices: at most nbThreads(), and 1 inside an OpenMP parallel region.
+  */
+template<typename Index>
+inline Index parallel_chunks(Index size, Index grain)
+{
+#if defined(EIGEN_HAS_THREAD_POOL) || defined(EIGEN_HAS_OPENMP)
+  #if !defined(EIGEN_HAS_THREAD_POOL)
+  if(omp_get_num_threads()>1)
+    return 1;
+  #endif
+  return (std::max)(Index(1), (std::min)(Index(nbThreads()), size / (std::max)(grain, Index(1))));
+#else
+  EIGEN_UNUSED_VARIABLE(size);
+  EIGEN_UNUSED_VARIABLE(grain);
+  return 1;
+#endif
+}
+
+/** \internal Calls func(i) for every i in [0,tasks), using up to nbThreads() threads, and returns once all
+  * the calls are done. The calls may run one after the other, so they must not wait for each other.
+  * The backend is the thread pool when EIGEN_USE_THREAD_POOL is defined, OpenMP otherwise when
+  * available, and a plain loop without threads.
+  */
+template<typename Functor>
+void parallel_run(int tasks, const Functor& func)
+{
+#if defined(EIGEN_HAS_THREAD_POOL)
+  thread_pool& pool = thread_pool::instance();
+  pool.ensure_workers(nbThreads()-1);
+  pool.run(tasks, func);
+#elif defined(EIGEN_HAS_OPENMP)
+  #pragma omp parallel for schedule(dynamic,1) num_threads((std::min)(tasks, nbThreads()))
+  for(int i=0; i<tasks; ++i)
+    func(i);
+#else
+  for(int i=0; i<tasks; ++i)
+    func(i);
+#endif
+}
+
+template<typename Functor, typename Index> struct parallel_for_chunk
+{
+  parallel_for_chunk(const Functor& func, Index size, Index chunks) : m_func(func), m_size(size), m_chunks(chunks) {}
+  void operator()(int i) const
+  {
+    m_func(m_size / m_chunks * i, (i+1==m_chunks) ? m_size : m_size / m_chunks * (i+1));
+  }
+  const Functor& m_func;
+  Index m_size, m_chunks;
+};
+
+/** \internal Splits [0,size) into parallel_chunks(size,grain) contiguous ranges and calls func(first,last)
+  * on each of them in parallel.
+  */
+template<typename Index, typename Functor>
+void parallel_for(Index size, Index grain, const Functor& func)
+{
+  Index chunks = parallel_chunks(size, grain);
+  if(chunks==1)
+    func(Index(0), size);
+  else
+    parallel_run(int(chunks), parallel_for_chunk<Functor,Index>(func, size, chunks));
+}
+
+// Runs the block of rows (or columns) of the i-th thread of a parallel GEMM
+template<typename Functor, typename Index> struct gemm_parallel_block
+{
+  void operator()(Index i) const
+  {
+    Index r0 = i*blockRows;
+    Index actualBlockRows = (i+1==threads) ? rows-r0 : blockRows;
+
+    Index c0 = i*blockCols;
+    Index actualBlockCols = (i+1==threads) ? cols-c0 : blockCols;
+
+    info[i].rhs_start = c0;
+    info[i].rhs_length = actualBlockCols;
+
+    if(transpose)
+      (*func)(0, cols, r0, actualBlockRows, info);
+    else
+      (*func)(r0, actualBlockRows, 0,cols, info);
+  }
+
+  const Functor* func;
+  GemmParallelInfo<Index>* info;
+  Index rows, cols, blockRows, blockCols, threads;
+  bool transpose;
+};
+
 template<bool Condition, typename Functor, typename Index>
 void parallelize_gemm(const Functor& func, Index rows, Index cols, bool transpose)
 {
   // TODO when EIGEN_USE_BLAS is defined,
   // we should still enable OMP for other scalar types
-#if !(defined (EIGEN_HAS_OPENMP)) || defined (EIGEN_USE_BLAS)
+#if !(defined (EIGEN_HAS_OPENMP) || defined (EIGEN_HAS_THREAD_POOL)) || defined (EIGEN_USE_BLAS)
   // FIXME the transpose variable is only needed to properly split
   // the matrix product when multithreading is enabled. This is a temporary
   // fix to support row-major destination matrices. This whole
@@ -96,16 +239,20 @@ void parallelize_gemm(const Functor& func, Index rows, Index cols, bool transpos
   func(0,rows, 0,cols);
 #else
 
-  // Dynamically check whether we should enable or disable OpenMP.
+  // Dynamically check whether we should enable or disable multithreading.
   // The conditions are:
   // - the max number of threads we can create is greater than 1
-  // - we are not already in a parallel code
+  // - we are not already in a parallel code (OpenMP), or there are idle workers (thread pool)
   // - the sizes are large enough
 
   // 1- are we already in a parallel session?
-  // FIXME omp_get_num_threads()>1 only works for openmp, what if the user does not use openmp?
+  #ifdef EIGEN_HAS_THREAD_POOL
+  if(!Condition)
+    return func(0,rows, 0,cols);
+  #else
   if((!Condition) || (omp_get_num_threads()>1))
     return func(0,rows, 0,cols);
+  #endif
 
   Index size = transpose ? cols : rows;
 
@@ -119,36 +266,42 @@ void parallelize_gemm(const Functor& func, Index rows, Index cols, bool transpos
   if(threads==1)
     return func(0,rows, 0,cols);
 
+  // The threads of a GEMM wait for each other: with the pool, they run as a gang of
+  // the workers which are idle right now, possibly fewer than requested.
+  #ifdef EIGEN_HAS_THREAD_POOL
+  thread_pool& pool = thread_pool::instance();
+  pool.ensure_workers(nbThreads()-1);
+  int workers[thread_pool::MaxWorkers];
+  threads = 1 + pool.reserve(int((std::min<Index>)(threads-1, thread_pool::MaxWorkers)), workers);
+  if(threads==1)
+    return func(0,rows, 0,cols);
+  #endif
+
   Eigen::initParallel();
   func.initParallelSession();
 
   if(transpose)
     std::swap(rows,cols);
 
-  Index blockCols = (cols / threads) & ~Index(0x3);
-  Index blockRows = (rows / threads) & ~Index(0x7);
-  
-  GemmParallelInfo<Index>* info = new GemmParallelInfo<Index>[threads];
+  gemm_parallel_block<Functor,Index> block;
+  block.func = &func;
+  block.rows = rows;
+  block.cols = cols;
+  block.blockCols = (cols / threads) & ~Index(0x3);
+  block.blockRows = (rows / threads) & ~Index(0x7);
+  block.threads = threads;
+  block.transpose = transpose;
+  block.info = new GemmParallelInfo<Index>[threads];
 
+  #ifdef EIGEN_HAS_THREAD_POOL
+  pool.run_gang(int(threads), workers, block);
+  #else
   #pragma omp parallel for schedule(static,1) num_threads(threads)
   for(Index i=0; i<threads; ++i)
-  {
-    Index r0 = i*blockRows;
-    Index actualBlockRows = (i+1==threads) ? rows-r0 : blockRows;
-
-    Index c0 = i*blockCols;
-    Index actualBlockCols = (i+1==threads) ? cols-c0 : blockCols;
-
-    info[i].rhs_start = c0;
-    info[i].rhs_length = actualBlockCols;
-
-    if(transpose)
-      func(0, cols, r0, actualBlockRows, info);
-    else
-      func(r0, actualBlockRows, 0,cols, info);
-  }
+    block(i);
+  #endif
 
-  delete[] info;
+  delete[] block.info;
 #endif
 }
 
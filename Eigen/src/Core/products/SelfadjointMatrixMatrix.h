@@ -91,11 +91,18 @@ struct symm_pack_rhs
       {
         blockB[count+0] = rhs(k,j2+0);
         blockB[count+1] = rhs(k,j2+1);
-        if (nr==4)
+        if (nr>=4)
         {
           blockB[count+2] = rhs(k,j2+2);
           blockB[count+3] = rhs(k,j2+3);
         }
+        if (nr==8)
+        {
+          blockB[count+4] = rhs(k,j2+4);
+          blockB[count+5] = rhs(k,j2+5);
+          blockB[count+6] = rhs(k,j2+6);
+          blockB[count+7] = rhs(k,j2+7);
+        }
         count += nr;
       }
     }
@@ -109,11 +116,18 @@ struct symm_pack_rhs
       {
         blockB[count+0] = conj(rhs(j2+0,k));
         blockB[count+1] = conj(rhs(j2+1,k));
-        if (nr==4)
+        if (nr>=4)
         {
           blockB[count+2] = conj(rhs(j2+2,k));
           blockB[count+3] = conj(rhs(j2+3,k));
         }
+        if (nr==8)
+        {
+          blockB[count+4] = conj(rhs(j2+4,k));
+          blockB[count+5] = conj(rhs(j2+5,k));
+          blockB[count+6] = conj(rhs(j2+6,k));
+          blockB[count+7] = conj(rhs(j2+7,k));
+        }
         count += nr;
       }
       // symmetric
@@ -137,11 +151,18 @@ struct symm_pack_rhs
       {
         blockB[count+0] = rhs(k,j2+0);
         blockB[count+1] = rhs(k,j2+1);
-        if (nr==4)
+        if (nr>=4)
         {
           blockB[count+2] = rhs(k,j2+2);
           blockB[count+3] = rhs(k,j2+3);
         }
+        if (nr==8)
+        {
+          blockB[count+4] = rhs(k,j2+4);
+          blockB[count+5] = rhs(k,j2+5);
+          blockB[count+6] = rhs(k,j2+6);
+          blockB[count+7] = rhs(k,j2+7);
+        }
         count += nr;
       }
     }
@@ -153,11 +174,18 @@ struct symm_pack_rhs
       {
         blockB[count+0] = conj(rhs(j2+0,k));
         blockB[count+1] = conj(rhs(j2+1,k));
-        if (nr==4)
+        if (nr>=4)
         {
           blockB[count+2] = conj(rhs(j2+2,k));
           blockB[count+3] = conj(rhs(j2+3,k));
         }
+        if (nr==8)
+        {
+          blockB[count+4] = conj(rhs(j2+4,k));
+          blockB[count+5] = conj(rhs(j2+5,k));
+          blockB[count+6] = conj(rhs(j2+6,k));
+          blockB[count+7] = conj(rhs(j2+7,k));
+        }
         count += nr;
       }
     }
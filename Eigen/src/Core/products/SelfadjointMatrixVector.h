@@ -33,6 +33,33 @@ static EIGEN_DONT_INLINE void run(
   const Scalar* _rhs, Index rhsIncr,
   Scalar* res,
   Scalar alpha)
+{
+  // FIXME this copy is now handled outside product_selfadjoint_vector, so it could probably be removed.
+  // if the rhs is not sequentially stored in memory we copy it to a temporary buffer,
+  // this is because we need to extract packets
+  ei_declare_aligned_stack_constructed_variable(Scalar,rhs,size,rhsIncr==1 ? const_cast<Scalar*>(_rhs) : 0);  
+  if (rhsIncr!=1)
+  {
+    const Scalar* it = _rhs;
+    for (Index i=0; i<size; ++i, it+=rhsIncr)
+      rhs[i] = *it;
+  }
+
+  run_columns(size, lhs, lhsStride, rhs, res, alpha, 0, size);
+}
+
+/** \internal Adds the contribution of the stored columns (rows if row-major) \a first to \a last-1
+  * of the triangle to \a res. A column j updates res[j] and the coefficients of \a res on the rows
+  * it stores, that is [j+1,size) for a lower column-major triangle and [0,j) for an upper one.
+  * The rhs must be sequentially stored in memory.
+  */
+static EIGEN_DONT_INLINE void run_columns(
+  Index size,
+  const Scalar* lhs, Index lhsStride,
+  const Scalar* rhs,
+  Scalar* res,
+  Scalar alpha,
+  Index first, Index last)
 {
   typedef typename packet_traits<Scalar>::type Packet;
   typedef typename NumTraits<Scalar>::Real RealScalar;
@@ -53,23 +80,14 @@ static EIGEN_DONT_INLINE void run(
 
   Scalar cjAlpha = ConjugateRhs ? conj(alpha) : alpha;
 
-  // FIXME this copy is now handled outside product_selfadjoint_vector, so it could probably be removed.
-  // if the rhs is not sequentially stored in memory we copy it to a temporary buffer,
-  // this is because we need to extract packets
-  ei_declare_aligned_stack_constructed_variable(Scalar,rhs,size,rhsIncr==1 ? const_cast<Scalar*>(_rhs) : 0);  
-  if (rhsIncr!=1)
-  {
-    const Scalar* it = _rhs;
-    for (Index i=0; i<size; ++i, it+=rhsIncr)
-      rhs[i] = *it;
-  }
-
-  Index bound = (std::max)(Index(0),size-8) & 0xfffffffe;
-  if (FirstTriangular)
-    bound = size - bound;
+  // the columns are processed by pairs, except the (at most 8) shortest ones
+  Index bound = FirstTriangular ? (std::min)((std::max)(first,Index(8)),last)
+                                : (std::max)((std::min)(last,size-8),first);
+  bound = FirstTriangular ? last - ((last-bound) & ~Index(1))
+                          : first + ((bound-first) & ~Index(1));
 
-  for (Index j=FirstTriangular ? bound : 0;
-       j<(FirstTriangular ? size : bound);j+=2)
+  for (Index j=FirstTriangular ? bound : first;
+       j<(FirstTriangular ? last : bound);j+=2)
   {
     register const Scalar* EIGEN_RESTRICT A0 = lhs + j*lhsStride;
     register const Scalar* EIGEN_RESTRICT A1 = lhs + (j+1)*lhsStride;
@@ -105,9 +123,9 @@ static EIGEN_DONT_INLINE void run(
 
     for (size_t i=starti; i<alignedStart; ++i)
     {
-      res[i] += t0 * A0[i] + t1 * A1[i];
-      t2 += conj(A0[i]) * rhs[i];
-      t3 += conj(A1[i]) * rhs[i];
+      res[i] += cj0.pmul(A0[i], t0) + cj0.pmul(A1[i],t1);
+      t2 += cj1.pmul(A0[i], rhs[i]);
+      t3 += cj1.pmul(A1[i], rhs[i]);
     }
     // Yes this an optimization for gcc 4.3 and 4.4 (=> huge speed up)
     // gcc 4.2 does this optimization automatically.
@@ -137,7 +155,7 @@ static EIGEN_DONT_INLINE void run(
     res[j]   += alpha * (t2 + predux(ptmp2));
     res[j+1] += alpha * (t3 + predux(ptmp3));
   }
-  for (Index j=FirstTriangular ? 0 : bound;j<(FirstTriangular ? bound : size);j++)
+  for (Index j=FirstTriangular ? first : bound;j<(FirstTriangular ? bound : last);j++)
   {
     register const Scalar* EIGEN_RESTRICT A0 = lhs + j*lhsStride;
 
@@ -155,6 +173,121 @@ static EIGEN_DONT_INLINE void run(
 }
 };
 
+/* Multithreaded selfadjoint matrix * vector product:
+ * the stored columns are split into blocks holding the same number of
+ * coefficients of the triangle. Each thread adds the contribution of its
+ * block to its own partial result, so that the stored half is read only
+ * once, and the partial results are then summed into the result by rows.
+ * Matrices whose triangle is smaller than EIGEN_PARALLEL_GEMV_THRESHOLD
+ * bytes are processed by the calling thread.
+ */
+template<typename Scalar, typename Index, int StorageOrder, int UpLo, bool ConjugateLhs, bool ConjugateRhs>
+struct parallel_selfadjoint_matrix_vector_product
+{
+typedef selfadjoint_matrix_vector_product<Scalar,Index,StorageOrder,UpLo,ConjugateLhs,ConjugateRhs,BuiltIn> Kernel;
+enum { FirstTriangular = (StorageOrder==RowMajor) == (UpLo==Lower) };
+
+// The rows of res updated by the columns [c0,c1)
+static Index rows_begin(Index c0)             { return FirstTriangular ? 0 : c0; }
+static Index rows_end(Index c1, Index size)   { return FirstTriangular ? c1 : size; }
+
+// Runs the i-th block of columns into the i-th partial result
+struct block
+{
+  void operator()(int i) const
+  {
+    Scalar* r = partial + i*partialStride;
+    std::fill(r + rows_begin(bounds[i]), r + rows_end(bounds[i+1],size), Scalar(0));
+    Kernel::run_columns(size, lhs, lhsStride, rhs, r, alpha, bounds[i], bounds[i+1]);
+  }
+
+  Index size;
+  const Scalar* lhs; Index lhsStride;
+  const Scalar* rhs;
+  Scalar alpha;
+  const Index* bounds;
+  Scalar* partial; Index partialStride;
+};
+
+// Sums the partial results into the rows [first,last) of res
+struct reduction
+{
+  void operator()(Index first, Index last) const
+  {
+    typedef Map<Matrix<Scalar,Dynamic,1> > MappedVector;
+    for(Index t=0; t<threads; ++t)
+    {
+      const Index r0 = (std::max)(first, rows_begin(bounds[t]));
+      const Index r1 = (std::min)(last, rows_end(bounds[t+1],size));
+      if(r0<r1)
+        MappedVector(res+r0, r1-r0) += MappedVector(partial + t*partialStride + r0, r1-r0);
+    }
+  }
+
+  Index size, threads;
+  const Index* bounds;
+  Scalar* partial; Index partialStride;
+  Scalar* res;
+};
+
+static void run(
+  Index size,
+  const Scalar* lhs, Index lhsStride,
+  const Scalar* rhs, Index rhsIncr,
+  Scalar* res,
+  Scalar alpha)
+{
+#if (defined(EIGEN_HAS_OPENMP) || defined(EIGEN_HAS_THREAD_POOL)) && !defined(EIGEN_USE_BLAS)
+  const double bytes = 0.5*double(size)*double(size+1)*double(sizeof(Scalar));
+  if(rhsIncr==1 && bytes >= double(EIGEN_PARALLEL_GEMV_THRESHOLD))
+  {
+    // at least 32kB of the triangle per thread
+    const Index threads = parallel_chunks(Index(bytes/32768), Index(1));
+    if(threads>1)
+    {
+      // the column j of the triangle holds size-j coefficients, or j+1 when FirstTriangular
+      ei_declare_aligned_stack_constructed_variable(Index,bounds,(threads+1),0);
+      const double total = bytes/double(sizeof(Scalar));
+      double area = 0;
+      Index t = 1;
+      bounds[0] = 0;
+      for(Index j=0; j<size && t<threads; ++j)
+      {
+        area += FirstTriangular ? double(j+1) : double(size-j);
+        if(area >= total*double(t)/double(threads))
+          bounds[t++] = j+1;
+      }
+      for(; t<=threads; ++t)
+        bounds[t] = size;
+
+      // one cache line between the partial results of two threads
+      const Index partialStride = (size + 15) & ~Index(15);
+      ei_declare_aligned_stack_constructed_variable(Scalar,partial,threads*partialStride,0);
+
+      block b;
+      b.size = size;
+      b.lhs = lhs; b.lhsStride = lhsStride;
+      b.rhs = rhs;
+      b.alpha = alpha;
+      b.bounds = bounds;
+      b.partial = partial; b.partialStride = partialStride;
+      parallel_run(int(threads), b);
+
+      reduction r;
+      r.size = size; r.threads = threads;
+      r.bounds = bounds;
+      r.partial = partial; r.partialStride = partialStride;
+      r.res = res;
+      parallel_for(size, Index(4096/sizeof(Scalar)), r);
+      return;
+    }
+  }
+#endif
+  selfadjoint_matrix_vector_product<Scalar,Index,StorageOrder,UpLo,ConjugateLhs,ConjugateRhs>::run(
+    size, lhs, lhsStride, rhs, rhsIncr, res, alpha);
+}
+};
+
 } // end namespace internal 
 
 /***************************************************************************
@@ -227,7 +360,7 @@ struct SelfadjointProductMatrix<Lhs,LhsMode,false,Rhs,0,true>
     }
       
       
-    internal::selfadjoint_matrix_vector_product<Scalar, Index, (internal::traits<_ActualLhsType>::Flags&RowMajorBit) ? RowMajor : ColMajor, int(LhsUpLo), bool(LhsBlasTraits::NeedToConjugate), bool(RhsBlasTraits::NeedToConjugate)>::run
+    internal::parallel_selfadjoint_matrix_vector_product<Scalar, Index, (internal::traits<_ActualLhsType>::Flags&RowMajorBit) ? RowMajor : ColMajor, int(LhsUpLo), bool(LhsBlasTraits::NeedToConjugate), bool(RhsBlasTraits::NeedToConjugate)>::run
       (
         lhs.rows(),                             // size
         &lhs.coeffRef(0,0),  lhs.outerStride(), // lhs info
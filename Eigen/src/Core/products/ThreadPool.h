@@ -0,0 +1,314 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_THREAD_POOL_H
+#define EIGEN_THREAD_POOL_H
+
+#ifdef EIGEN_HAS_THREAD_POOL
+
+namespace Eigen {
+
+namespace internal {
+
+/** \internal
+  * \class thread_pool
+  * \brief The worker threads of Eigen's parallel kernels when EIGEN_USE_THREAD_POOL is defined
+  *
+  * Each worker owns a deque of tasks. It runs its own tasks last in first out and, when it runs
+  * dry, steals the oldest task of another worker, so nested parallel loops spread over the idle
+  * workers. The thread which submits a group of tasks helps running tasks until its group is done,
+  * hence a parallel loop started from inside a task never blocks a worker.
+  *
+  * The threads of a parallel GEMM wait for each other, so they must all run at the same time.
+  * They are run as a gang: reserve() takes idle workers out of the pool, and each of them then runs
+  * exactly one task of the gang. A kernel called while the pool is busy, e.g. from an outer
+  * parallel loop, gets a smaller gang or none at all instead of oversubscribing the cores.
+  */
+class thread_pool
+{
+  public:
+    enum { MaxWorkers = 256 };
+
+    struct task
+    {
+      void (*run)(const void* body, int index);
+      const void* body;
+      int index;
+      int gang;               // size of the gang the task belongs to, 0 for queued tasks
+      std::atomic<int>* pending;
+    };
+
+    static thread_pool& instance()
+    {
+      static thread_pool pool;
+      return pool;
+    }
+
+    ~thread_pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_wakeup.notify_all();
+      for(int i = 0; i < m_count; ++i)
+      {
+        m_workers[i]->thread.join();
+        delete m_workers[i];
+      }
+    }
+
+    /** Starts worker threads until there are at least \a workers of them */
+    void ensure_workers(int workers)
+    {
+      workers = (std::min)(workers, int(MaxWorkers));
+      if(m_count.load() >= workers)
+        return;
+      std::lock_guard<std::mutex> lock(m_mutex);
+      while(m_count.load() < workers)
+      {
+        int id = m_count.load();
+        m_workers[id] = new worker;
+        m_workers[id]->thread = std::thread(&thread_pool::work, this, id);
+        m_count.store(id + 1);
+      }
+    }
+
+    /** Calls func(i) for i in [0,tasks) and returns once they are all done. func(0) runs in the
+      * calling thread, the others are queued for the workers. The calls must not wait for each other.
+      */
+    template<typename Functor>
+    void run(int tasks, const Functor& func)
+    {
+      if(tasks <= 1)
+      {
+        if(tasks == 1) func(0);
+        return;
+      }
+      std::atomic<int> pending(tasks - 1);
+      int self = current_worker();
+      {
+        std::deque<task>& queue = self >= 0 ? m_workers[self]->queue : m_injected;
+        std::lock_guard<std::mutex> lock(self >= 0 ? m_workers[self]->mutex : m_injected_mutex);
+        for(int i = 1; i < tasks; ++i)
+        {
+          task t = { &invoke<Functor>, &func, i, 0, &pending };
+          queue.push_back(t);
+        }
+      }
+      signal();
+      func(0);
+      while(pending.load(std::memory_order_acquire) > 0)
+      {
+        task t;
+        if(find_task(self, t))
+          execute(t);
+        else
+          std::this_thread::yield();
+      }
+    }
+
+    /** Reserves up to \a count idle workers for a gang and stores their ids in \a ids.
+      * \returns the number of reserved workers, which must then be given to run_gang().
+      */
+    int reserve(int count, int* ids)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      int reserved = 0;
+      while(reserved < count && !m_idle.empty())
+      {
+        int id = m_idle.back();
+        m_idle.pop_back();
+        m_workers[id]->idle = false;
+        m_workers[id]->reserved = true;
+        ids[reserved++] = id;
+      }
+      return reserved;
+    }
+
+    /** Runs func(0) in the calling thread and func(i) on the reserved worker ids[i-1], 0 < i < size,
+      * all at the same time, then gives the workers back to the pool.
+      */
+    template<typename Functor>
+    void run_gang(int size, const int* ids, const Functor& func)
+    {
+      std::atomic<int> pending(size - 1);
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(int i = 1; i < size; ++i)
+        {
+          task t = { &invoke<Functor>, &func, i, size, &pending };
+          m_workers[ids[i-1]]->mail = t;
+          m_workers[ids[i-1]]->has_mail = true;
+        }
+      }
+      m_wakeup.notify_all();
+      gang_member scope(0, size);
+      func(0);
+      while(pending.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+    }
+
+    /** \returns the rank of the calling thread in its gang, and the size of the gang */
+    static int& gang_rank() { static thread_local int rank = 0; return rank; }
+    static int& gang_size() { static thread_local int size = 1; return size; }
+
+  private:
+    struct worker
+    {
+      worker() : idle(false), reserved(false), has_mail(false) {}
+      std::thread thread;
+      std::mutex mutex;       // protects queue
+      std::deque<task> queue;
+      // protected by thread_pool::m_mutex
+      bool idle;
+      bool reserved;
+      bool has_mail;
+      task mail;
+    };
+
+    // Sets the gang rank and size of the calling thread while in scope
+    struct gang_member
+    {
+      gang_member(int rank, int size) : m_rank(gang_rank()), m_size(gang_size())
+      { gang_rank() = rank; gang_size() = size; }
+      ~gang_member() { gang_rank() = m_rank; gang_size() = m_size; }
+      int m_rank, m_size;
+    };
+
+    thread_pool() : m_count(0), m_version(0), m_stop(false) {}
+    thread_pool(const thread_pool&);
+    thread_pool& operator=(const thread_pool&);
+
+    static int& current_worker() { static thread_local int id = -1; return id; }
+
+    template<typename Functor>
+    static void invoke(const void* body, int index) { (*static_cast<const Functor*>(body))(index); }
+
+    static void execute(const task& t)
+    {
+      t.run(t.body, t.index);
+      t.pending->fetch_sub(1, std::memory_order_release);
+    }
+
+    void signal()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_version;
+      }
+      m_wakeup.notify_all();
+    }
+
+    // Pops from the worker's own deque, then from the injected tasks, then steals
+    bool find_task(int self, task& t)
+    {
+      if(self >= 0 && pop(m_workers[self]->mutex, m_workers[self]->queue, t, false))
+        return true;
+      if(pop(m_injected_mutex, m_injected, t, true))
+        return true;
+      int count = m_count.load();
+      for(int i = 1; i <= count; ++i)
+      {
+        int victim = (self + i) % count;
+        if(victim < 0) victim += count;
+        if(victim != self && pop(m_workers[victim]->mutex, m_workers[victim]->queue, t, true))
+          return true;
+      }
+      return false;
+    }
+
+    static bool pop(std::mutex& mutex, std::deque<task>& queue, task& t, bool oldest)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if(queue.empty())
+        return false;
+      if(oldest)
+      {
+        t = queue.front();
+        queue.pop_front();
+      }
+      else
+      {
+        t = queue.back();
+        queue.pop_back();
+      }
+      return true;
+    }
+
+    void work(int id)
+    {
+      current_worker() = id;
+      worker& self = *m_workers[id];
+      for(;;)
+      {
+        unsigned long version;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          if(self.reserved)
+          {
+            m_wakeup.wait(lock, [&]{ return self.has_mail || m_stop; });
+            if(!self.has_mail)
+              return;
+            task t = self.mail;
+            lock.unlock();
+            {
+              gang_member scope(t.index, t.gang);
+              t.run(t.body, t.index);
+            }
+            lock.lock();
+            self.has_mail = false;
+            self.reserved = false;
+            lock.unlock();
+            t.pending->fetch_sub(1, std::memory_order_release);
+            continue;
+          }
+          if(m_stop)
+            return;
+          version = m_version;
+        }
+
+        task t;
+        if(find_task(id, t))
+        {
+          execute(t);
+          continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if(m_version != version || self.reserved || m_stop)
+          continue;
+        self.idle = true;
+        m_idle.push_back(id);
+        m_wakeup.wait(lock, [&]{ return m_version != version || self.reserved || m_stop; });
+        if(self.idle)
+        {
+          self.idle = false;
+          m_idle.erase(std::find(m_idle.begin(), m_idle.end(), id));
+        }
+      }
+    }
+
+    worker* m_workers[MaxWorkers];
+    std::atomic<int> m_count;
+    std::mutex m_injected_mutex;
+    std::deque<task> m_injected;    // tasks submitted by threads outside the pool
+
+    std::mutex m_mutex;             // protects the fields below and the idle/reserved/mail fields of the workers
+    std::condition_variable m_wakeup;
+    std::vector<int> m_idle;
+    unsigned long m_version;        // incremented whenever tasks are queued
+    bool m_stop;
+};
+
+} // end namespace internal
+
+} // end namespace Eigen
+
+#endif // EIGEN_HAS_THREAD_POOL
+
+#endif // EIGEN_THREAD_POOL_H
@@ -406,7 +406,10 @@ namespace Architecture
     Generic = 0x0,
     SSE = 0x1,
     AltiVec = 0x2,
-#if defined EIGEN_VECTORIZE_SSE
+    AVX = 0x4,
+#if defined EIGEN_VECTORIZE_AVX
+    Target = AVX
+#elif defined EIGEN_VECTORIZE_SSE
     Target = SSE
 #elif defined EIGEN_VECTORIZE_ALTIVEC
     Target = AltiVec
@@ -123,8 +123,9 @@ inline void* handmade_aligned_realloc(void* ptr, size_t size, size_t = 0)
 *** Implementation of generic aligned realloc (when no realloc can be used)***
 *****************************************************************************/
 
-void* aligned_malloc(size_t size);
-void  aligned_free(void *ptr);
+void  check_that_malloc_is_allowed();
+void* aligned_malloc_impl(size_t size);
+void  aligned_free_impl(void *ptr);
 
 /** \internal
   * \brief Reallocates aligned memory.
@@ -133,16 +134,18 @@ void  aligned_free(void *ptr);
   */
 inline void* generic_aligned_realloc(void* ptr, size_t size, size_t old_size)
 {
+  check_that_malloc_is_allowed();
+
   if (ptr==0)
-    return aligned_malloc(size);
+    return aligned_malloc_impl(size);
 
   if (size==0)
   {
-    aligned_free(ptr);
+    aligned_free_impl(ptr);
     return 0;
   }
 
-  void* newptr = aligned_malloc(size);
+  void* newptr = aligned_malloc_impl(size);
   if (newptr == 0)
   {
     #ifdef EIGEN_HAS_ERRNO
@@ -154,12 +157,268 @@ inline void* generic_aligned_realloc(void* ptr, size_t size, size_t old_size)
   if (ptr != 0)
   {
     std::memcpy(newptr, ptr, (std::min)(size,old_size));
-    aligned_free(ptr);
+    aligned_free_impl(ptr);
   }
 
   return newptr;
 }
 
+/*****************************************************************************
+*** Allocation headers: statistics and pluggable allocators                ***
+*****************************************************************************/
+
+} // end namespace internal
+
+/** \class AllocationStats
+  * \ingroup Core_Module
+  *
+  * \brief Counters of the heap allocations made by Eigen
+  *
+  * When EIGEN_ALLOCATION_STATS is defined, every block obtained through internal::aligned_malloc()
+  * and internal::conditional_aligned_malloc() is accounted for: the storage of dynamic-size objects,
+  * the temporaries of expressions and the blocking buffers of the products. Each block then carries
+  * a 16-byte header with its size, so that frees and reallocations are accounted too. Buffers that
+  * ei_declare_aligned_stack_constructed_variable places on the stack are not heap allocations and
+  * are not counted.
+  *
+  * \sa allocationStats(), resetAllocationStats(), AllocationTag, NoAllocationScope
+  */
+struct AllocationStats
+{
+  enum { SizeClasses = 8*sizeof(std::size_t)+1 };
+  std::size_t liveBytes;      ///< bytes currently allocated
+  std::size_t peakBytes;      ///< maximum of liveBytes since the last reset
+  std::size_t totalBytes;     ///< bytes allocated since the last reset
+  std::size_t allocations;    ///< number of allocations since the last reset
+  std::size_t deallocations;  ///< number of deallocations since the last reset
+  std::size_t reallocations;  ///< number of reallocations since the last reset
+  /** number of allocations of \f$ 2^{k-1} \leq size < 2^k \f$ bytes (k=0 counts empty blocks) */
+  std::size_t sizeClasses[SizeClasses];
+};
+
+/** \brief Allocations made while an AllocationTag of a given name was active */
+struct AllocationTagStats
+{
+  const char* name;
+  std::size_t allocations;
+  std::size_t bytes;
+};
+
+/** \class Allocator
+  * \ingroup Core_Module
+  *
+  * \brief Interface of the allocators which can serve Eigen's heap allocations
+  *
+  * When EIGEN_PLUGGABLE_ALLOCATOR is defined, the allocations that Eigen makes in a thread while an
+  * AllocatorScope is active are served by its allocator instead of malloc. Every block remembers the
+  * allocator it comes from, so it can be freed after the scope has ended, but not after the
+  * allocator has been destroyed.
+  *
+  * \sa BumpArena, PoolAllocator, AllocatorScope
+  */
+class Allocator
+{
+  public:
+    virtual ~Allocator() {}
+    /** \returns a 16-byte aligned block of \a size bytes, or null on allocation error */
+    virtual void* allocate(std::size_t size) = 0;
+    /** Releases a block of \a size bytes returned by allocate() */
+    virtual void deallocate(void* ptr, std::size_t size) = 0;
+};
+
+/** \brief Placement of the large blocks when EIGEN_HUGE_PAGES is defined
+  *
+  * With EIGEN_HUGE_PAGES defined on Linux, the blocks of at least \c threshold bytes which are not
+  * served by an AllocatorScope are mapped directly with mmap, optionally backed by huge pages (fewer
+  * TLB misses on large dense matrices) and interleaved across the NUMA nodes. Otherwise their pages
+  * are placed on the node of the thread that first touches them, see EIGEN_PARALLEL_FILL_THRESHOLD.
+  *
+  * \sa setLargeAllocationPolicy()
+  */
+struct LargeAllocationPolicy
+{
+  enum HugePages {
+    NoHugePages,            ///< regular pages
+    TransparentHugePages,   ///< madvise(MADV_HUGEPAGE), the kernel backs what it can with huge pages
+    ExplicitHugePages       ///< MAP_HUGETLB from the reserved pool, transparent ones when it is exhausted
+  };
+  std::size_t threshold;    ///< blocks of at least this many bytes are mapped, 0 disables the policy
+  HugePages hugePages;
+  bool interleave;          ///< interleave the pages across the NUMA nodes
+};
+
+namespace internal {
+
+inline LargeAllocationPolicy& large_allocation_policy()
+{
+  static LargeAllocationPolicy policy = { std::size_t(16) << 20, LargeAllocationPolicy::TransparentHugePages, false };
+  return policy;
+}
+
+#if defined(EIGEN_HUGE_PAGES) && defined(__linux__)
+  #define EIGEN_HAS_LARGE_PAGE_ALLOCATOR 1
+#else
+  #define EIGEN_HAS_LARGE_PAGE_ALLOCATOR 0
+#endif
+
+#if defined(EIGEN_ALLOCATION_STATS) || defined(EIGEN_PLUGGABLE_ALLOCATOR) || EIGEN_HAS_LARGE_PAGE_ALLOCATOR
+  #define EIGEN_HAS_ALLOCATION_HEADER 1
+#else
+  #define EIGEN_HAS_ALLOCATION_HEADER 0
+#endif
+
+#if EIGEN_HAS_ALLOCATION_HEADER
+
+#ifdef _MSC_VER
+  #define EIGEN_ALLOCATION_THREAD_LOCAL __declspec(thread)
+#else
+  #define EIGEN_ALLOCATION_THREAD_LOCAL __thread
+#endif
+
+/** \internal Header in front of each block. Its size is padded to 16 bytes to preserve the alignment. */
+struct allocation_header
+{
+  std::size_t size;   // bytes requested by the user
+  Allocator* owner;   // null for blocks which come from malloc
+};
+enum { allocation_header_size = 16 };
+
+/** \internal \returns the header of the block holding the user pointer \a ptr */
+inline allocation_header* allocation_header_of(void* ptr)
+{
+  return reinterpret_cast<allocation_header*>(static_cast<char*>(ptr) - allocation_header_size);
+}
+
+#endif // EIGEN_HAS_ALLOCATION_HEADER
+
+#ifdef EIGEN_ALLOCATION_STATS
+
+enum { max_allocation_tags = 64 };
+
+// The counters are shared by the threads of the parallel products. Without the
+// GCC atomic builtins they are not thread safe.
+inline std::size_t allocation_stats_add(std::size_t& counter, std::size_t value)
+{
+#ifdef __GNUC__
+  return __sync_add_and_fetch(&counter, value);
+#else
+  return counter += value;
+#endif
+}
+
+inline void allocation_stats_max(std::size_t& counter, std::size_t value)
+{
+  std::size_t current;
+#ifdef __GNUC__
+  while((current = counter) < value && !__sync_bool_compare_and_swap(&counter, current, value)) {}
+#else
+  if((current = counter) < value) counter = value;
+#endif
+}
+
+inline AllocationStats& allocation_stats()
+{
+  static AllocationStats stats;
+  return stats;
+}
+
+inline AllocationTagStats* allocation_tags()
+{
+  static AllocationTagStats tags[max_allocation_tags];
+  return tags;
+}
+
+inline int& allocation_tag_count()
+{
+  static int count;
+  return count;
+}
+
+inline const char*& current_allocation_tag()
+{
+  static EIGEN_ALLOCATION_THREAD_LOCAL const char* tag;
+  return tag;
+}
+
+inline int& no_allocation_depth()
+{
+  static EIGEN_ALLOCATION_THREAD_LOCAL int depth;
+  return depth;
+}
+
+/** \internal \returns the entry of the tag \a name, adding it if needed, or 0 if the table is full */
+inline AllocationTagStats* find_allocation_tag(const char* name)
+{
+  static int lock;
+#ifdef __GNUC__
+  while(__sync_lock_test_and_set(&lock, 1)) {}
+#endif
+  AllocationTagStats* tags = allocation_tags();
+  int& count = allocation_tag_count();
+  int i = 0;
+  while(i < count && tags[i].name != name && std::strcmp(tags[i].name, name) != 0)
+    ++i;
+  AllocationTagStats* result = 0;
+  if(i < count)
+    result = tags + i;
+  else if(count < max_allocation_tags)
+  {
+    result = tags + count++;
+    result->name = name;
+  }
+#ifdef __GNUC__
+  __sync_lock_release(&lock);
+#endif
+  return result;
+}
+
+inline void record_allocated_bytes(std::size_t size)
+{
+  eigen_assert(no_allocation_depth()==0 && "heap allocation is forbidden inside a NoAllocationScope");
+  AllocationStats& stats = allocation_stats();
+  allocation_stats_add(stats.totalBytes, size);
+  allocation_stats_max(stats.peakBytes, allocation_stats_add(stats.liveBytes, size));
+  if(const char* name = current_allocation_tag())
+    if(AllocationTagStats* tag = find_allocation_tag(name))
+    {
+      allocation_stats_add(tag->allocations, 1);
+      allocation_stats_add(tag->bytes, size);
+    }
+}
+
+/** \internal Records a new block of \a size bytes */
+inline void record_allocation(std::size_t size)
+{
+  std::size_t size_class = 0;
+  for(std::size_t s = size; s; s >>= 1)
+    ++size_class;
+  AllocationStats& stats = allocation_stats();
+  allocation_stats_add(stats.allocations, 1);
+  allocation_stats_add(stats.sizeClasses[size_class], 1);
+  record_allocated_bytes(size);
+}
+
+/** \internal Records a block of \a old_size bytes which has been reallocated to \a new_size bytes */
+inline void record_reallocation(std::size_t old_size, std::size_t new_size)
+{
+  AllocationStats& stats = allocation_stats();
+  allocation_stats_add(stats.reallocations, 1);
+  if(new_size > old_size)
+    record_allocated_bytes(new_size - old_size);
+  else
+    allocation_stats_add(stats.liveBytes, std::size_t(0) - (old_size - new_size));
+}
+
+/** \internal Records the deallocation of a block of \a size bytes */
+inline void record_deallocation(std::size_t size)
+{
+  AllocationStats& stats = allocation_stats();
+  allocation_stats_add(stats.deallocations, 1);
+  allocation_stats_add(stats.liveBytes, std::size_t(0) - size);
+}
+
+#endif // EIGEN_ALLOCATION_STATS
+
 /*****************************************************************************
 *** Implementation of portable aligned versions of malloc/free/realloc     ***
 *****************************************************************************/
@@ -188,13 +447,11 @@ inline void check_that_malloc_is_allowed()
 {}
 #endif
 
-/** \internal Allocates \a size bytes. The returned pointer is guaranteed to have 16 bytes alignment.
-  * On allocation error, the returned pointer is null, and std::bad_alloc is thrown.
+/** \internal Allocates \a size bytes with the platform's aligned allocator, without accounting.
+  * \returns a 16-byte aligned pointer, or null on allocation error.
   */
-inline void* aligned_malloc(size_t size)
+inline void* aligned_malloc_impl(size_t size)
 {
-  check_that_malloc_is_allowed();
-
   void *result;
   #if !EIGEN_ALIGN
     result = std::malloc(size);
@@ -209,15 +466,11 @@ inline void* aligned_malloc(size_t size)
   #else
     result = handmade_aligned_malloc(size);
   #endif
-
-  if(!result && size)
-    throw_std_bad_alloc();
-
   return result;
 }
 
-/** \internal Frees memory allocated with aligned_malloc. */
-inline void aligned_free(void *ptr)
+/** \internal Frees memory allocated with aligned_malloc_impl. */
+inline void aligned_free_impl(void *ptr)
 {
   #if !EIGEN_ALIGN
     std::free(ptr);
@@ -234,12 +487,8 @@ inline void aligned_free(void *ptr)
   #endif
 }
 
-/**
-* \internal
-* \brief Reallocates an aligned block of memory.
-* \throws std::bad_alloc on allocation failure
-**/
-inline void* aligned_realloc(void *ptr, size_t new_size, size_t old_size)
+/** \internal Reallocates memory allocated with aligned_malloc_impl, returns null on allocation error. */
+inline void* aligned_realloc_impl(void *ptr, size_t new_size, size_t old_size)
 {
   EIGEN_UNUSED_VARIABLE(old_size);
 
@@ -264,6 +513,249 @@ inline void* aligned_realloc(void *ptr, size_t new_size, size_t old_size)
 #else
   result = handmade_aligned_realloc(ptr,new_size,old_size);
 #endif
+  return result;
+}
+
+#if EIGEN_HAS_ALLOCATION_HEADER
+
+#ifdef EIGEN_PLUGGABLE_ALLOCATOR
+inline Allocator*& current_allocator()
+{
+  static EIGEN_ALLOCATION_THREAD_LOCAL Allocator* allocator;
+  return allocator;
+}
+#else
+inline Allocator* current_allocator() { return 0; }
+#endif
+
+#if EIGEN_HAS_LARGE_PAGE_ALLOCATOR
+
+/** \internal Maps the blocks selected by the LargeAllocationPolicy */
+class large_page_allocator : public Allocator
+{
+  public:
+    static large_page_allocator& instance()
+    {
+      static large_page_allocator allocator;
+      return allocator;
+    }
+
+    void* allocate(std::size_t size)
+    {
+      const LargeAllocationPolicy& policy = large_allocation_policy();
+      std::size_t length = mapped_length(size);
+      void* block = MAP_FAILED;
+      #ifdef MAP_HUGETLB
+      if(policy.hugePages == LargeAllocationPolicy::ExplicitHugePages)
+        block = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      #endif
+      if(block == MAP_FAILED)
+        block = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(block == MAP_FAILED)
+        return 0;
+      #ifdef MADV_HUGEPAGE
+      if(policy.hugePages != LargeAllocationPolicy::NoHugePages)
+        madvise(block, length, MADV_HUGEPAGE);
+      #endif
+      #ifdef SYS_mbind
+      if(policy.interleave && nodes() > 1)
+        syscall(SYS_mbind, block, length, 3 /* MPOL_INTERLEAVE */, m_nodeMask, long(MaxNodes), 0);
+      #endif
+      return block;
+    }
+
+    void deallocate(void* ptr, std::size_t size)
+    {
+      munmap(ptr, mapped_length(size));
+    }
+
+  private:
+    enum { HugePageSize = 2 << 20, MaxNodes = 1024, BitsPerWord = 8*sizeof(unsigned long) };
+
+    large_page_allocator() : m_nodes(-1) {}
+
+    // Whole huge pages, so that the mapping can be backed by them
+    static std::size_t mapped_length(std::size_t size)
+    {
+      return (size + HugePageSize - 1) & ~std::size_t(HugePageSize - 1);
+    }
+
+    // Reads the online NUMA nodes into the mbind node mask, e.g. "0-1" or "0,2-3"
+    int nodes()
+    {
+      if(m_nodes >= 0)
+        return m_nodes;
+      std::memset(m_nodeMask, 0, sizeof(m_nodeMask));
+      m_nodes = 0;
+      std::FILE* file = std::fopen("/sys/devices/system/node/online", "r");
+      if(file == 0)
+        return m_nodes;
+      int first, last, fields;
+      char separator = ',';
+      while(separator == ',' && (fields = std::fscanf(file, "%d%c", &first, &separator)) >= 1)
+      {
+        last = first;
+        if(fields == 1)
+          separator = '\n';
+        else if(separator == '-' && std::fscanf(file, "%d%c", &last, &separator) < 1)
+          break;
+        for(int node = first; node <= last && node < MaxNodes; ++node, ++m_nodes)
+          m_nodeMask[node / BitsPerWord] |= 1UL << (node % BitsPerWord);
+      }
+      std::fclose(file);
+      return m_nodes;
+    }
+
+    int m_nodes;
+    unsigned long m_nodeMask[MaxNodes / BitsPerWord];
+};
+
+/** \internal \returns the allocator of the blocks of \a size bytes selected by the LargeAllocationPolicy, or null */
+inline Allocator* large_block_allocator(std::size_t size)
+{
+  std::size_t threshold = large_allocation_policy().threshold;
+  return threshold && size >= threshold ? &large_page_allocator::instance() : 0;
+}
+
+#else
+
+inline Allocator* large_block_allocator(std::size_t) { return 0; }
+
+#endif // EIGEN_HAS_LARGE_PAGE_ALLOCATOR
+
+template<bool Align> inline void* raw_malloc(size_t size) { return aligned_malloc_impl(size); }
+template<> inline void* raw_malloc<false>(size_t size) { return std::malloc(size); }
+template<bool Align> inline void raw_free(void* ptr) { aligned_free_impl(ptr); }
+template<> inline void raw_free<false>(void* ptr) { std::free(ptr); }
+template<bool Align> inline void* raw_realloc(void* ptr, size_t new_size, size_t old_size)
+{ return aligned_realloc_impl(ptr, new_size, old_size); }
+template<> inline void* raw_realloc<false>(void* ptr, size_t new_size, size_t)
+{ return std::realloc(ptr, new_size); }
+
+/** \internal Allocates a block with a header from the current allocator. If there is none, large
+  * blocks are mapped according to the LargeAllocationPolicy and the others come from malloc.
+  * \returns the user pointer, or null on allocation error.
+  */
+template<bool Align> inline void* header_malloc(size_t size)
+{
+  Allocator* owner = current_allocator();
+  void* block;
+  if(owner)
+    block = owner->allocate(size+allocation_header_size);
+  else
+  {
+    owner = large_block_allocator(size);
+    block = owner ? owner->allocate(size+allocation_header_size) : 0;
+    if(block == 0)
+    {
+      owner = 0;
+      block = raw_malloc<Align>(size+allocation_header_size);
+    }
+  }
+  if(block == 0)
+    return 0;
+  allocation_header* header = static_cast<allocation_header*>(block);
+  header->size = size;
+  header->owner = owner;
+  #ifdef EIGEN_ALLOCATION_STATS
+    record_allocation(size);
+  #endif
+  return static_cast<char*>(block) + allocation_header_size;
+}
+
+/** \internal Frees a block allocated with header_malloc, whatever its allocator */
+template<bool Align> inline void header_free(void* ptr)
+{
+  if(ptr == 0)
+    return;
+  allocation_header* header = allocation_header_of(ptr);
+  #ifdef EIGEN_ALLOCATION_STATS
+    record_deallocation(header->size);
+  #endif
+  if(header->owner)
+    header->owner->deallocate(header, header->size+allocation_header_size);
+  else
+    raw_free<Align>(header);
+}
+
+/** \internal Reallocates a block allocated with header_malloc. It stays with the allocator it comes from.
+  * \returns the user pointer, or null on allocation error.
+  */
+template<bool Align> inline void* header_realloc(void* ptr, size_t new_size)
+{
+  if(ptr == 0)
+    return header_malloc<Align>(new_size);
+  allocation_header* header = allocation_header_of(ptr);
+  size_t old_size = header->size;
+  Allocator* owner = header->owner;
+  void* block;
+  if(owner)
+  {
+    block = owner->allocate(new_size+allocation_header_size);
+    if(block)
+    {
+      std::memcpy(block, header, allocation_header_size + (std::min)(old_size, new_size));
+      owner->deallocate(header, old_size+allocation_header_size);
+    }
+  }
+  else
+    block = raw_realloc<Align>(header, new_size+allocation_header_size, old_size+allocation_header_size);
+  if(block == 0)
+    return 0;
+  static_cast<allocation_header*>(block)->size = new_size;
+  #ifdef EIGEN_ALLOCATION_STATS
+    record_reallocation(old_size, new_size);
+  #endif
+  return static_cast<char*>(block) + allocation_header_size;
+}
+
+#endif // EIGEN_HAS_ALLOCATION_HEADER
+
+/** \internal Allocates \a size bytes. The returned pointer is guaranteed to have 16 bytes alignment.
+  * On allocation error, the returned pointer is null, and std::bad_alloc is thrown.
+  */
+inline void* aligned_malloc(size_t size)
+{
+  check_that_malloc_is_allowed();
+
+  #if EIGEN_HAS_ALLOCATION_HEADER
+    void *result = header_malloc<true>(size);
+  #else
+    void *result = aligned_malloc_impl(size);
+  #endif
+
+  if(!result && size)
+    throw_std_bad_alloc();
+
+  return result;
+}
+
+/** \internal Frees memory allocated with aligned_malloc. */
+inline void aligned_free(void *ptr)
+{
+  #if EIGEN_HAS_ALLOCATION_HEADER
+    header_free<true>(ptr);
+  #else
+    aligned_free_impl(ptr);
+  #endif
+}
+
+/**
+* \internal
+* \brief Reallocates an aligned block of memory.
+* \throws std::bad_alloc on allocation failure
+**/
+inline void* aligned_realloc(void *ptr, size_t new_size, size_t old_size)
+{
+  void *result;
+#if EIGEN_HAS_ALLOCATION_HEADER
+  EIGEN_UNUSED_VARIABLE(old_size);
+  if(ptr==0)
+    check_that_malloc_is_allowed();
+  result = header_realloc<true>(ptr, new_size);
+#else
+  result = aligned_realloc_impl(ptr,new_size,old_size);
+#endif
 
   if (!result && new_size)
     throw_std_bad_alloc();
@@ -287,7 +779,11 @@ template<> inline void* conditional_aligned_malloc<false>(size_t size)
 {
   check_that_malloc_is_allowed();
 
-  void *result = std::malloc(size);
+  #if EIGEN_HAS_ALLOCATION_HEADER
+    void *result = header_malloc<false>(size);
+  #else
+    void *result = std::malloc(size);
+  #endif
   if(!result && size)
     throw_std_bad_alloc();
   return result;
@@ -301,7 +797,11 @@ template<bool Align> inline void conditional_aligned_free(void *ptr)
 
 template<> inline void conditional_aligned_free<false>(void *ptr)
 {
-  std::free(ptr);
+  #if EIGEN_HAS_ALLOCATION_HEADER
+    header_free<false>(ptr);
+  #else
+    std::free(ptr);
+  #endif
 }
 
 template<bool Align> inline void* conditional_aligned_realloc(void* ptr, size_t new_size, size_t old_size)
@@ -311,7 +811,14 @@ template<bool Align> inline void* conditional_aligned_realloc(void* ptr, size_t
 
 template<> inline void* conditional_aligned_realloc<false>(void* ptr, size_t new_size, size_t)
 {
-  return std::realloc(ptr, new_size);
+  #if EIGEN_HAS_ALLOCATION_HEADER
+    void *result = header_realloc<false>(ptr, new_size);
+    if(!result && new_size)
+      throw_std_bad_alloc();
+    return result;
+  #else
+    return std::realloc(ptr, new_size);
+  #endif
 }
 
 /*****************************************************************************
@@ -571,15 +1078,15 @@ template<typename T> class aligned_stack_memory_handler
     Eigen::internal::check_size_for_overflow<TYPE>(SIZE); \
     TYPE* NAME = (BUFFER)!=0 ? (BUFFER) \
                : reinterpret_cast<TYPE*>( \
-                      (sizeof(TYPE)*SIZE<=EIGEN_STACK_ALLOCATION_LIMIT) ? EIGEN_ALIGNED_ALLOCA(sizeof(TYPE)*SIZE) \
-                    : Eigen::internal::aligned_malloc(sizeof(TYPE)*SIZE) );  \
-    Eigen::internal::aligned_stack_memory_handler<TYPE> EIGEN_CAT(NAME,_stack_memory_destructor)((BUFFER)==0 ? NAME : 0,SIZE,sizeof(TYPE)*SIZE>EIGEN_STACK_ALLOCATION_LIMIT)
+                      (sizeof(TYPE)*(SIZE)<=EIGEN_STACK_ALLOCATION_LIMIT) ? EIGEN_ALIGNED_ALLOCA(sizeof(TYPE)*(SIZE)) \
+                    : Eigen::internal::aligned_malloc(sizeof(TYPE)*(SIZE)) );  \
+    Eigen::internal::aligned_stack_memory_handler<TYPE> EIGEN_CAT(NAME,_stack_memory_destructor)((BUFFER)==0 ? NAME : 0,SIZE,sizeof(TYPE)*(SIZE)>EIGEN_STACK_ALLOCATION_LIMIT)
 
 #else
 
   #define ei_declare_aligned_stack_constructed_variable(TYPE,NAME,SIZE,BUFFER) \
     Eigen::internal::check_size_for_overflow<TYPE>(SIZE); \
-    TYPE* NAME = (BUFFER)!=0 ? BUFFER : reinterpret_cast<TYPE*>(Eigen::internal::aligned_malloc(sizeof(TYPE)*SIZE));    \
+    TYPE* NAME = (BUFFER)!=0 ? BUFFER : reinterpret_cast<TYPE*>(Eigen::internal::aligned_malloc(sizeof(TYPE)*(SIZE)));    \
     Eigen::internal::aligned_stack_memory_handler<TYPE> EIGEN_CAT(NAME,_stack_memory_destructor)((BUFFER)==0 ? NAME : 0,SIZE,true)
     
 #endif
@@ -954,6 +1461,436 @@ inline int queryTopLevelCacheSize()
 
 } // end namespace internal
 
+/*****************************************************************************
+*** Allocation statistics, public interface                                ***
+*****************************************************************************/
+
+/** \returns a snapshot of the counters of Eigen's heap allocations. They are all zero unless
+  * EIGEN_ALLOCATION_STATS is defined.
+  * \sa AllocationStats, resetAllocationStats()
+  */
+inline AllocationStats allocationStats()
+{
+#ifdef EIGEN_ALLOCATION_STATS
+  return internal::allocation_stats();
+#else
+  AllocationStats stats;
+  std::memset(&stats, 0, sizeof(stats));
+  return stats;
+#endif
+}
+
+/** Restarts the counters of allocationStats() and of the allocation tags from zero. The live bytes
+  * are kept, and the peak restarts from them.
+  */
+inline void resetAllocationStats()
+{
+#ifdef EIGEN_ALLOCATION_STATS
+  AllocationStats& stats = internal::allocation_stats();
+  std::size_t live = stats.liveBytes;
+  std::memset(&stats, 0, sizeof(stats));
+  stats.liveBytes = stats.peakBytes = live;
+  AllocationTagStats* tags = internal::allocation_tags();
+  for(int i = 0; i < internal::allocation_tag_count(); ++i)
+    tags[i].allocations = tags[i].bytes = 0;
+#endif
+}
+
+/** \returns the number of distinct AllocationTag names seen so far */
+inline int allocationTagCount()
+{
+#ifdef EIGEN_ALLOCATION_STATS
+  return internal::allocation_tag_count();
+#else
+  return 0;
+#endif
+}
+
+/** \returns the allocations made under the \a i -th AllocationTag name, 0 <= i < allocationTagCount() */
+inline AllocationTagStats allocationTagStats(int i)
+{
+#ifdef EIGEN_ALLOCATION_STATS
+  eigen_assert(i >= 0 && i < internal::allocation_tag_count());
+  return internal::allocation_tags()[i];
+#else
+  EIGEN_UNUSED_VARIABLE(i);
+  eigen_assert(false && "there are no allocation tags (EIGEN_ALLOCATION_STATS is not defined)");
+  AllocationTagStats stats = {0, 0, 0};
+  return stats;
+#endif
+}
+
+/** \class AllocationTag
+  * \ingroup Core_Module
+  *
+  * \brief Attributes the allocations of the current thread to a call site while it is in scope
+  *
+  * The name must be a string that outlives the program's use of the statistics, typically a
+  * literal. Tags can be nested, the innermost one wins. At most 64 distinct names are tracked.
+  * \code
+  * {
+  *   EIGEN_ALLOCATION_TAG("tridiagonalization");
+  *   internal::tridiagonalization_inplace(mat, diag, subdiag, true);
+  * }
+  * \endcode
+  * Without EIGEN_ALLOCATION_STATS this class does nothing.
+  *
+  * \sa allocationTagStats()
+  */
+class AllocationTag
+{
+  public:
+    explicit AllocationTag(const char* name)
+    {
+#ifdef EIGEN_ALLOCATION_STATS
+      m_previous = internal::current_allocation_tag();
+      internal::current_allocation_tag() = name;
+#else
+      EIGEN_UNUSED_VARIABLE(name);
+#endif
+    }
+    ~AllocationTag()
+    {
+#ifdef EIGEN_ALLOCATION_STATS
+      internal::current_allocation_tag() = m_previous;
+#endif
+    }
+  private:
+    AllocationTag(const AllocationTag&);
+    AllocationTag& operator=(const AllocationTag&);
+#ifdef EIGEN_ALLOCATION_STATS
+    const char* m_previous;
+#endif
+};
+
+#define EIGEN_ALLOCATION_TAG(NAME) Eigen::AllocationTag EIGEN_CAT(eigen_allocation_tag_,__LINE__)(NAME)
+
+/** \class NoAllocationScope
+  * \ingroup Core_Module
+  *
+  * \brief Forbids heap allocations by Eigen in the current thread while it is in scope
+  *
+  * With EIGEN_ALLOCATION_STATS defined, any allocation or growing reallocation made through Eigen's
+  * allocator inside the scope fails an eigen_assert, i.e. it aborts debug builds. Unlike
+  * EIGEN_RUNTIME_NO_MALLOC the restriction is per thread, so it can guard the inner loop of a
+  * solver while other threads keep allocating.
+  */
+class NoAllocationScope
+{
+  public:
+    NoAllocationScope()
+    {
+#ifdef EIGEN_ALLOCATION_STATS
+      ++internal::no_allocation_depth();
+#endif
+    }
+    ~NoAllocationScope()
+    {
+#ifdef EIGEN_ALLOCATION_STATS
+      --internal::no_allocation_depth();
+#endif
+    }
+  private:
+    NoAllocationScope(const NoAllocationScope&);
+    NoAllocationScope& operator=(const NoAllocationScope&);
+};
+
+/*****************************************************************************
+*** Placement of large blocks (EIGEN_HUGE_PAGES)                           ***
+*****************************************************************************/
+
+/** \returns the current LargeAllocationPolicy */
+inline LargeAllocationPolicy largeAllocationPolicy()
+{
+  return internal::large_allocation_policy();
+}
+
+/** Sets how the large blocks are allocated from now on. The default maps the blocks of 16 MiB
+  * and more with transparent huge pages and first-touch NUMA placement. It only has an effect
+  * when EIGEN_HUGE_PAGES is defined, on Linux.
+  * \sa LargeAllocationPolicy
+  */
+inline void setLargeAllocationPolicy(const LargeAllocationPolicy& policy)
+{
+  internal::large_allocation_policy() = policy;
+}
+
+/*****************************************************************************
+*** Pluggable allocators (EIGEN_PLUGGABLE_ALLOCATOR)                       ***
+*****************************************************************************/
+
+/** \class BumpArena
+  * \ingroup Core_Module
+  *
+  * \brief Allocator handing out consecutive pieces of large chunks
+  *
+  * An allocation is a pointer bump. Freeing the most recent block gives its memory back, and once
+  * every block has been freed the arena rewinds to its first chunk, after merging the chunks it had
+  * to add into a single one. The temporaries of an iterative loop thus reuse the same memory at every
+  * iteration without calling malloc.
+  *
+  * An arena serves one thread: its blocks must be allocated and freed by the thread of the
+  * AllocatorScope, and they must all be freed before the arena is destroyed.
+  */
+class BumpArena : public Allocator
+{
+  public:
+    explicit BumpArena(std::size_t chunkSize = std::size_t(1) << 20)
+      : m_chunks(0), m_current(0), m_top(0), m_end(0), m_chunkSize(chunkSize), m_live(0)
+    {}
+
+    ~BumpArena()
+    {
+      eigen_assert(m_live == 0 && "a BumpArena is destroyed while some of its blocks are in use");
+      release();
+    }
+
+    void* allocate(std::size_t size)
+    {
+      size = round(size);
+      if(std::size_t(m_end - m_top) < size && !grow(size))
+        return 0;
+      void* result = m_top;
+      m_top += size;
+      ++m_live;
+      return result;
+    }
+
+    void deallocate(void* ptr, std::size_t size)
+    {
+      if(static_cast<char*>(ptr) + round(size) == m_top)
+        m_top = static_cast<char*>(ptr);
+      if(--m_live == 0)
+        rewind();
+    }
+
+    /** \returns the number of blocks in use */
+    std::size_t liveBlocks() const { return m_live; }
+
+  private:
+    // A chunk starts with its link and capacity, its data begin 16 bytes later
+    struct Chunk { Chunk* next; std::size_t capacity; };
+    enum { ChunkHeaderSize = 16 };
+
+    static std::size_t round(std::size_t size) { return (size + 15) & ~std::size_t(15); }
+    static char* begin(Chunk* chunk) { return reinterpret_cast<char*>(chunk) + ChunkHeaderSize; }
+
+    bool grow(std::size_t size)
+    {
+      Chunk* next = m_current ? m_current->next : m_chunks;
+      if(next == 0 || next->capacity < size)
+      {
+        std::size_t capacity = (std::max)(size, m_chunkSize);
+        Chunk* chunk = static_cast<Chunk*>(internal::aligned_malloc_impl(ChunkHeaderSize + capacity));
+        if(chunk == 0)
+          return false;
+        chunk->capacity = capacity;
+        chunk->next = next;
+        if(m_current)
+          m_current->next = chunk;
+        else
+          m_chunks = chunk;
+        next = chunk;
+      }
+      m_current = next;
+      m_top = begin(next);
+      m_end = m_top + next->capacity;
+      return true;
+    }
+
+    void rewind()
+    {
+      if(m_chunks && m_chunks->next)
+      {
+        std::size_t capacity = 0;
+        for(Chunk* chunk = m_chunks; chunk; chunk = chunk->next)
+          capacity += chunk->capacity;
+        release();
+        m_chunkSize = (std::max)(m_chunkSize, capacity);
+      }
+      m_current = m_chunks;
+      m_top = m_chunks ? begin(m_chunks) : 0;
+      m_end = m_chunks ? m_top + m_chunks->capacity : 0;
+    }
+
+    void release()
+    {
+      while(m_chunks)
+      {
+        Chunk* next = m_chunks->next;
+        internal::aligned_free_impl(m_chunks);
+        m_chunks = next;
+      }
+      m_current = 0;
+      m_top = m_end = 0;
+    }
+
+    BumpArena(const BumpArena&);
+    BumpArena& operator=(const BumpArena&);
+
+    Chunk* m_chunks;
+    Chunk* m_current;
+    char* m_top;
+    char* m_end;
+    std::size_t m_chunkSize;
+    std::size_t m_live;
+};
+
+/** \class PoolAllocator
+  * \ingroup Core_Module
+  *
+  * \brief Allocator recycling blocks of power-of-two size classes
+  *
+  * Blocks of up to MaxPooledSize bytes are rounded up to a power of two, carved out of large chunks
+  * and kept on a free list of their size class when they are freed, so the workspaces that a solver
+  * allocates and frees in any order are recycled without calling malloc. Larger blocks are passed
+  * to the platform allocator. The memory of the chunks is returned when the pool is destroyed.
+  *
+  * Like BumpArena, a pool serves one thread and must outlive its blocks.
+  */
+class PoolAllocator : public Allocator
+{
+  public:
+    enum {
+      MinBlockSize = 16,
+      SizeClasses = 17,                                   ///< 16 bytes to 1 MiB
+      MaxPooledSize = MinBlockSize << (SizeClasses-1)
+    };
+
+    explicit PoolAllocator(std::size_t chunkSize = std::size_t(4) << 20)
+      : m_chunks(0), m_top(0), m_end(0), m_chunkSize((std::max)(chunkSize, std::size_t(MaxPooledSize)))
+    {
+      for(int k = 0; k < SizeClasses; ++k)
+        m_free[k] = 0;
+    }
+
+    ~PoolAllocator()
+    {
+      while(m_chunks)
+      {
+        FreeBlock* next = m_chunks->next;
+        internal::aligned_free_impl(m_chunks);
+        m_chunks = next;
+      }
+    }
+
+    void* allocate(std::size_t size)
+    {
+      if(size > std::size_t(MaxPooledSize))
+        return internal::aligned_malloc_impl(size);
+      int k = sizeClass(size);
+      if(FreeBlock* block = m_free[k])
+      {
+        m_free[k] = block->next;
+        return block;
+      }
+      std::size_t blockSize = std::size_t(MinBlockSize) << k;
+      if(std::size_t(m_end - m_top) < blockSize && !grow())
+        return 0;
+      void* result = m_top;
+      m_top += blockSize;
+      return result;
+    }
+
+    void deallocate(void* ptr, std::size_t size)
+    {
+      if(size > std::size_t(MaxPooledSize))
+      {
+        internal::aligned_free_impl(ptr);
+        return;
+      }
+      int k = sizeClass(size);
+      FreeBlock* block = static_cast<FreeBlock*>(ptr);
+      block->next = m_free[k];
+      m_free[k] = block;
+    }
+
+  private:
+    struct FreeBlock { FreeBlock* next; };
+    enum { ChunkHeaderSize = 16 };
+
+    static int sizeClass(std::size_t size)
+    {
+      int k = 0;
+      while((std::size_t(MinBlockSize) << k) < size)
+        ++k;
+      return k;
+    }
+
+    // Starts a new chunk, the rest of the current one is given to the free lists
+    bool grow()
+    {
+      for(int k = SizeClasses-1; k >= 0; --k)
+        while(std::size_t(m_end - m_top) >= (std::size_t(MinBlockSize) << k))
+        {
+          deallocate(m_top, std::size_t(MinBlockSize) << k);
+          m_top += std::size_t(MinBlockSize) << k;
+        }
+      FreeBlock* chunk = static_cast<FreeBlock*>(internal::aligned_malloc_impl(ChunkHeaderSize + m_chunkSize));
+      if(chunk == 0)
+        return false;
+      chunk->next = m_chunks;
+      m_chunks = chunk;
+      m_top = reinterpret_cast<char*>(chunk) + ChunkHeaderSize;
+      m_end = m_top + m_chunkSize;
+      return true;
+    }
+
+    PoolAllocator(const PoolAllocator&);
+    PoolAllocator& operator=(const PoolAllocator&);
+
+    FreeBlock* m_free[SizeClasses];
+    FreeBlock* m_chunks;
+    char* m_top;
+    char* m_end;
+    std::size_t m_chunkSize;
+};
+
+/** \class AllocatorScope
+  * \ingroup Core_Module
+  *
+  * \brief Makes an Allocator serve the heap allocations of the current thread while it is in scope
+  *
+  * \code
+  * Eigen::BumpArena arena;
+  * Eigen::MatrixXd eigenvalues(size, points);   // allocated before the scope, by malloc
+  * for(int i = 0; i < points; ++i)
+  * {
+  *   Eigen::AllocatorScope scope(arena);
+  *   Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(hamiltonian(i), Eigen::EigenvaluesOnly);
+  *   eigenvalues.col(i) = solver.eigenvalues();
+  * }                                             // solver freed before the scope ends
+  * \endcode
+  * The objects whose storage is allocated inside the scope must not outlive it: declare them inside
+  * the scope, so that they are destroyed before it ends and the allocator rewinds. Scopes can be
+  * nested. Without EIGEN_PLUGGABLE_ALLOCATOR this class does nothing.
+  */
+class AllocatorScope
+{
+  public:
+    explicit AllocatorScope(Allocator& allocator)
+    {
+#ifdef EIGEN_PLUGGABLE_ALLOCATOR
+      m_previous = internal::current_allocator();
+      internal::current_allocator() = &allocator;
+#else
+      EIGEN_UNUSED_VARIABLE(allocator);
+#endif
+    }
+    ~AllocatorScope()
+    {
+#ifdef EIGEN_PLUGGABLE_ALLOCATOR
+      internal::current_allocator() = m_previous;
+#endif
+    }
+  private:
+    AllocatorScope(const AllocatorScope&);
+    AllocatorScope& operator=(const AllocatorScope&);
+#ifdef EIGEN_PLUGGABLE_ALLOCATOR
+    Allocator* m_previous;
+#endif
+};
+
 } // end namespace Eigen
 
 #endif // EIGEN_MEMORY_H
@@ -150,7 +150,9 @@ class compute_matrix_flags
 
           )
       ) ? AlignedBit : 0,
-      packet_access_bit = packet_traits<Scalar>::Vectorizable && aligned_bit ? PacketAccessBit : 0
+      // a fixed size storage smaller than a packet, e.g. a Vector4f with AVX, is not vectorized
+      fits_packets = is_dynamic_size_storage || ((MaxCols*MaxRows) % packet_traits<Scalar>::size) == 0,
+      packet_access_bit = packet_traits<Scalar>::Vectorizable && aligned_bit && fits_packets ? PacketAccessBit : 0
     };
 
   public:
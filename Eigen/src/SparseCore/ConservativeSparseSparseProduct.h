@@ -14,6 +14,273 @@ namespace Eigen {
 
 namespace internal {
 
+/** \internal Accumulates the products contributing to one column of a sparse * sparse product.
+  * A column expecting few products relative to the number of rows is accumulated into a small open
+  * addressing hash table which stays in cache, while a denser column uses a dense mask over the rows.
+  * In both cases the entries are returned sorted by row index.
+  */
+template<typename Scalar, typename Index>
+class sparse_product_accumulator
+{
+  public:
+    sparse_product_accumulator(Index rows) : m_rows(rows), m_hashed(false), m_mask(0), m_size(0) {}
+
+    // prepares the accumulation of a column receiving at most \a flops products
+    void init(Index flops)
+    {
+      m_size = 0;
+      m_hashed = flops < m_rows/16;
+      if(m_hashed)
+      {
+        Index capacity = 16;
+        while(capacity < 2*flops)
+          capacity *= 2;
+        if(m_keys.size() < capacity)
+        {
+          m_keys.setConstant(capacity, -1);
+          m_values.resize(capacity);
+        }
+        m_mask = capacity-1;
+      }
+      else if(m_marker.size()==0)
+      {
+        m_marker.setConstant(m_rows, -1);
+        m_dense.resize(m_rows);
+      }
+      if(m_order.size() < flops)
+        m_order.resize(flops);
+    }
+
+    void mark(Index i)
+    {
+      bool inserted;
+      find(i, inserted);
+    }
+
+    void add(Index i, const Scalar& value)
+    {
+      bool inserted;
+      Scalar& acc = find(i, inserted);
+      if(inserted)
+        acc = value;
+      else
+        acc += value;
+    }
+
+    Index size() const { return m_size; }
+
+    // copies the accumulated entries sorted by row index to \a indices and \a values and resets the accumulator
+    template<typename ResIndex>
+    void flush(ResIndex* indices, Scalar* values)
+    {
+      if(m_hashed)
+      {
+        for(Index k=0; k<m_size; ++k)
+          indices[k] = ResIndex(m_keys[m_order[k]]);
+        std::sort(indices, indices+m_size);
+        for(Index k=0; k<m_size; ++k)
+          values[k] = m_values[slot(indices[k])];
+      }
+      else if(m_size*16 > m_rows)
+      {
+        // the column is dense enough to loop through the mask
+        Index k = 0;
+        for(Index i=0; i<m_rows; ++i)
+          if(m_marker[i]>=0)
+          {
+            indices[k] = ResIndex(i);
+            values[k++] = m_dense[i];
+          }
+      }
+      else
+      {
+        std::sort(&m_order[0], &m_order[0]+m_size);
+        for(Index k=0; k<m_size; ++k)
+        {
+          indices[k] = ResIndex(m_order[k]);
+          values[k] = m_dense[m_order[k]];
+        }
+      }
+      clear();
+    }
+
+    void clear()
+    {
+      for(Index k=0; k<m_size; ++k)
+      {
+        if(m_hashed)
+          m_keys[m_order[k]] = -1;
+        else
+          m_marker[m_order[k]] = -1;
+      }
+      m_size = 0;
+    }
+
+  protected:
+    // the slot of the hash table holding \a i, or the empty slot where to insert it
+    Index slot(Index i) const
+    {
+      Index h = Index((std::size_t(i) * std::size_t(2654435761u)) & std::size_t(m_mask));
+      while(m_keys[h]!=i && m_keys[h]!=-1)
+        h = (h+1) & m_mask;
+      return h;
+    }
+
+    Scalar& find(Index i, bool& inserted)
+    {
+      if(m_hashed)
+      {
+        Index h = slot(i);
+        inserted = m_keys[h]==-1;
+        if(inserted)
+        {
+          m_keys[h] = i;
+          m_order[m_size++] = h;
+        }
+        return m_values[h];
+      }
+      inserted = m_marker[i]<0;
+      if(inserted)
+      {
+        m_marker[i] = m_size;
+        m_order[m_size++] = i;
+      }
+      return m_dense[i];
+    }
+
+    Index m_rows;
+    bool m_hashed;
+    Index m_mask, m_size;
+    Matrix<Index,Dynamic,1> m_keys, m_marker, m_order;
+    Matrix<Scalar,Dynamic,1> m_values, m_dense;
+};
+
+/** \internal Two pass sparse * sparse product split among the threads by ranges of columns of the result
+  * holding about the same number of products:
+  *  - the number of products of each column is computed from the nonzeros of the lhs columns,
+  *  - a symbolic pass counts the nonzeros of each column, from which the compressed storage of the
+  *    result is allocated once,
+  *  - a numeric pass accumulates each column and writes it in place, sorted.
+  * Each thread owns its accumulator, and the result is the same as the one of the serial product.
+  */
+template<typename Lhs, typename Rhs, typename ResultType>
+struct conservative_sparse_sparse_product_parallel
+{
+  typedef typename remove_all<Lhs>::type::Scalar Scalar;
+  typedef typename remove_all<Lhs>::type::Index Index;
+
+  conservative_sparse_sparse_product_parallel(const Lhs& lhs, const Rhs& rhs, ResultType& res, int chunks)
+    : m_lhs(lhs), m_rhs(rhs), m_res(res), m_chunks(chunks), m_pass(0),
+      m_lhsNonZeros(lhs.outerSize()), m_flops(rhs.outerSize()+1), m_nonZeros(rhs.outerSize()), m_bounds(chunks+1)
+  {}
+
+  void run()
+  {
+    const Index cols = m_rhs.outerSize();
+    m_pass = 0;
+    parallel_run(m_chunks, *this);
+    m_pass = 1;
+    parallel_run(m_chunks, *this);
+
+    m_flops[0] = 0;
+    for(Index j=0; j<cols; ++j)
+      m_flops[j+1] += m_flops[j];
+    for(int i=0; i<m_chunks; ++i)
+      m_bounds[i] = Index(std::lower_bound(&m_flops[0], &m_flops[0]+cols, Index((double(m_flops[cols])*i)/m_chunks)) - &m_flops[0]);
+    m_bounds[m_chunks] = cols;
+
+    m_pass = 2;
+    parallel_run(m_chunks, *this);
+
+    m_res.setZero();
+    typename ResultType::Index* outerIndex = m_res.outerIndexPtr();
+    for(Index j=0; j<cols; ++j)
+      outerIndex[j+1] = outerIndex[j] + m_nonZeros[j];
+    m_res.data().resize(outerIndex[cols]);
+
+    m_pass = 3;
+    parallel_run(m_chunks, *this);
+  }
+
+  void operator()(int i) const
+  {
+    if(m_pass==0)
+      countLhs(i);
+    else if(m_pass==1)
+      countProducts(i);
+    else if(m_pass==2)
+      symbolic(i);
+    else
+      numeric(i);
+  }
+
+  // pass 1: the nonzeros of the i-th range of lhs columns
+  void countLhs(int i) const
+  {
+    Index size = m_lhs.outerSize();
+    for(Index k=size/m_chunks*i; k<((i+1==m_chunks) ? size : size/m_chunks*(i+1)); ++k)
+    {
+      Index nnz = 0;
+      for(typename Lhs::InnerIterator lhsIt(m_lhs, k); lhsIt; ++lhsIt)
+        ++nnz;
+      m_lhsNonZeros[k] = nnz;
+    }
+  }
+
+  // pass 2: the products of the i-th range of columns, stored shifted by one for the prefix sum
+  void countProducts(int i) const
+  {
+    Index size = m_rhs.outerSize();
+    for(Index j=size/m_chunks*i; j<((i+1==m_chunks) ? size : size/m_chunks*(i+1)); ++j)
+    {
+      Index flops = 0;
+      for(typename Rhs::InnerIterator rhsIt(m_rhs, j); rhsIt; ++rhsIt)
+        flops += m_lhsNonZeros[rhsIt.index()];
+      m_flops[j+1] = flops;
+    }
+  }
+
+  // pass 3: the nonzeros of each column of the i-th balanced range
+  void symbolic(int i) const
+  {
+    sparse_product_accumulator<Scalar,Index> acc(m_lhs.innerSize());
+    for(Index j=m_bounds[i]; j<m_bounds[i+1]; ++j)
+    {
+      acc.init(m_flops[j+1]-m_flops[j]);
+      for(typename Rhs::InnerIterator rhsIt(m_rhs, j); rhsIt; ++rhsIt)
+        for(typename Lhs::InnerIterator lhsIt(m_lhs, rhsIt.index()); lhsIt; ++lhsIt)
+          acc.mark(lhsIt.index());
+      m_nonZeros[j] = acc.size();
+      acc.clear();
+    }
+  }
+
+  // pass 4: the values of each column of the i-th balanced range, written in place
+  void numeric(int i) const
+  {
+    sparse_product_accumulator<Scalar,Index> acc(m_lhs.innerSize());
+    const typename ResultType::Index* outerIndex = m_res.outerIndexPtr();
+    for(Index j=m_bounds[i]; j<m_bounds[i+1]; ++j)
+    {
+      acc.init(m_flops[j+1]-m_flops[j]);
+      for(typename Rhs::InnerIterator rhsIt(m_rhs, j); rhsIt; ++rhsIt)
+      {
+        Scalar y = rhsIt.value();
+        for(typename Lhs::InnerIterator lhsIt(m_lhs, rhsIt.index()); lhsIt; ++lhsIt)
+          acc.add(lhsIt.index(), lhsIt.value() * y);
+      }
+      acc.flush(m_res.innerIndexPtr()+outerIndex[j], m_res.valuePtr()+outerIndex[j]);
+    }
+  }
+
+  const Lhs& m_lhs;
+  const Rhs& m_rhs;
+  ResultType& m_res;
+  int m_chunks;
+  int m_pass;
+  mutable Matrix<Index,Dynamic,1> m_lhsNonZeros, m_flops, m_nonZeros, m_bounds;
+};
+
 template<typename Lhs, typename Rhs, typename ResultType>
 static void conservative_sparse_sparse_product_impl(const Lhs& lhs, const Rhs& rhs, ResultType& res)
 {
@@ -37,6 +304,13 @@ static void conservative_sparse_sparse_product_impl(const Lhs& lhs, const Rhs& r
   // Therefore, we have nnz(lhs*rhs) = nnz(lhs) + nnz(rhs)
   Index estimated_nnz_prod = lhs.nonZeros() + rhs.nonZeros();
 
+  int chunks = int(parallel_chunks(estimated_nnz_prod, Index(EIGEN_PARALLEL_SPGEMM_THRESHOLD)));
+  if(chunks>1)
+  {
+    conservative_sparse_sparse_product_parallel<Lhs,Rhs,ResultType>(lhs, rhs, res, chunks).run();
+    return;
+  }
+
   res.setZero();
   res.reserve(Index(estimated_nnz_prod));
   // we compute each column of the result, one after the other
@@ -65,42 +339,21 @@ static void conservative_sparse_sparse_product_impl(const Lhs& lhs, const Rhs& r
       }
     }
 
-    // unordered insertion
-    for(int k=0; k<nnz; ++k)
-    {
-      int i = indices[k];
-      res.insertBackByOuterInnerUnordered(j,i) = values[i];
-      mask[i] = false;
-    }
-
-#if 0
-    // alternative ordered insertion code:
-
-    int t200 = rows/(log2(200)*1.39);
-    int t = (rows*100)/139;
-
-    // FIXME reserve nnz non zeros
-    // FIXME implement fast sort algorithms for very small nnz
-    // if the result is sparse enough => use a quick sort
-    // otherwise => loop through the entire vector
-    // In order to avoid to perform an expensive log2 when the
-    // result is clearly very sparse we use a linear bound up to 200.
-    //if((nnz<200 && nnz<t200) || nnz * log2(nnz) < t)
-    //res.startVec(j);
-    if(true)
+    // ordered insertion: if the result is sparse enough => sort the indices,
+    // otherwise => loop through the entire mask
+    if(nnz*16 <= rows)
     {
       if(nnz>1) std::sort(indices.data(),indices.data()+nnz);
-      for(int k=0; k<nnz; ++k)
+      for(Index k=0; k<nnz; ++k)
       {
-        int i = indices[k];
+        Index i = indices[k];
         res.insertBackByOuterInner(j,i) = values[i];
         mask[i] = false;
       }
     }
     else
     {
-      // dense path
-      for(int i=0; i<rows; ++i)
+      for(Index i=0; i<rows; ++i)
       {
         if(mask[i])
         {
@@ -109,7 +362,6 @@ static void conservative_sparse_sparse_product_impl(const Lhs& lhs, const Rhs& r
         }
       }
     }
-#endif
 
   }
   res.finalize();
@@ -134,13 +386,11 @@ struct conservative_sparse_sparse_product_selector<Lhs,Rhs,ResultType,ColMajor,C
 
   static void run(const Lhs& lhs, const Rhs& rhs, ResultType& res)
   {
-    typedef SparseMatrix<typename ResultType::Scalar,RowMajor> RowMajorMatrix;
     typedef SparseMatrix<typename ResultType::Scalar,ColMajor> ColMajorMatrix;
     ColMajorMatrix resCol(lhs.rows(),rhs.cols());
+    // the non zeros are inserted sorted
     internal::conservative_sparse_sparse_product_impl<Lhs,Rhs,ColMajorMatrix>(lhs, rhs, resCol);
-    // sort the non zeros:
-    RowMajorMatrix resRow(resCol);
-    res = resRow;
+    res = resCol;
   }
 };
 
@@ -229,12 +479,10 @@ struct conservative_sparse_sparse_product_selector<Lhs,Rhs,ResultType,RowMajor,R
   static void run(const Lhs& lhs, const Rhs& rhs, ResultType& res)
   {
     typedef SparseMatrix<typename ResultType::Scalar,RowMajor> RowMajorMatrix;
-    typedef SparseMatrix<typename ResultType::Scalar,ColMajor> ColMajorMatrix;
     RowMajorMatrix resRow(lhs.rows(),rhs.cols());
+    // the non zeros are inserted sorted
     internal::conservative_sparse_sparse_product_impl<Rhs,Lhs,RowMajorMatrix>(rhs, lhs, resRow);
-    // sort the non zeros:
-    ColMajorMatrix resCol(resRow);
-    res = resCol;
+    res = resRow;
   }
 };
 
@@ -142,6 +142,82 @@ template<typename SparseLhsType, typename DenseRhsType, typename DenseResType,
          bool ColPerCol = ((DenseRhsType::Flags&RowMajorBit)==0) || DenseRhsType::ColsAtCompileTime==1>
 struct sparse_time_dense_product_impl;
 
+// \returns the outer index array of a sparse matrix in compressed storage, or 0 for other expressions
+template<typename Lhs>
+inline const typename Lhs::Index* sparse_outer_index(const Lhs&) { return 0; }
+
+template<typename Scalar, int Options, typename Index>
+inline const Index* sparse_outer_index(const SparseMatrix<Scalar,Options,Index>& mat) { return mat.outerIndexPtr(); }
+
+template<typename Scalar, int Options, typename Index>
+inline const Index* sparse_outer_index(const MappedSparseMatrix<Scalar,Options,Index>& mat) { return mat.outerIndexPtr(); }
+
+template<typename MatrixType>
+inline const typename MatrixType::Index* sparse_outer_index(const Transpose<MatrixType>& mat)
+{ return sparse_outer_index(mat.nestedExpression()); }
+
+/** \internal \returns the number of threads among which a sparse * dense product with \a rhsCols columns
+  * is split: at least EIGEN_PARALLEL_SPMV_THRESHOLD nonzeros times columns per thread. Only sparse
+  * matrices in compressed storage, possibly transposed, are split, the others being processed serially.
+  */
+template<typename Lhs>
+inline typename Lhs::Index sparse_parallel_chunks(const Lhs& lhs, typename Lhs::Index rhsCols)
+{
+  typedef typename Lhs::Index Index;
+  const Index* outer = sparse_outer_index(lhs);
+  if(outer==0)
+    return 1;
+  return parallel_chunks(Index(outer[lhs.outerSize()]-outer[0])*rhsCols, Index(EIGEN_PARALLEL_SPMV_THRESHOLD));
+}
+
+/** \internal Splits the outer vectors of \a lhs into \a chunks ranges [bounds[i],bounds[i+1]) holding
+  * about the same number of nonzeros.
+  */
+template<typename Lhs>
+void sparse_balanced_outer_bounds(const Lhs& lhs, typename Lhs::Index chunks, typename Lhs::Index* bounds)
+{
+  typedef typename Lhs::Index Index;
+  const Index* outer = sparse_outer_index(lhs);
+  const Index n = lhs.outerSize();
+  const double nnz = double(outer[n]-outer[0]);
+  bounds[0] = 0;
+  for(Index i=1; i<chunks; ++i)
+  {
+    const Index target = outer[0] + Index(nnz*double(i)/double(chunks));
+    bounds[i] = (std::max)(bounds[i-1], Index(std::lower_bound(outer, outer+n, target) - outer));
+  }
+  bounds[chunks] = n;
+}
+
+// Sums the buffers into the rows [first,last) of the result
+template<typename DenseResType, typename Buffer>
+struct sparse_buffers_reduction
+{
+  typedef typename DenseResType::Index Index;
+  void operator()(Index first, Index last) const
+  {
+    for(Index i=0; i<count; ++i)
+      res->middleRows(first, last-first) += buffers->block(first, i*res->cols(), last-first, res->cols());
+  }
+  DenseResType* res;
+  const Buffer* buffers;
+  Index count;
+};
+
+/** \internal Adds to \a res the \a count partial results stored side by side in \a buffers, the rows
+  * being split among the threads.
+  */
+template<typename DenseResType, typename Buffer>
+void sparse_reduce_buffers(DenseResType& res, const Buffer& buffers, typename DenseResType::Index count)
+{
+  typedef typename DenseResType::Index Index;
+  sparse_buffers_reduction<DenseResType,Buffer> r;
+  r.res = &res;
+  r.buffers = &buffers;
+  r.count = count;
+  parallel_for(Index(res.rows()), Index(4096/sizeof(typename DenseResType::Scalar)), r);
+}
+
 template<typename SparseLhsType, typename DenseRhsType, typename DenseResType>
 struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, RowMajor, true>
 {
@@ -150,20 +226,62 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, R
   typedef typename internal::remove_all<DenseResType>::type Res;
   typedef typename Lhs::Index Index;
   typedef typename Lhs::InnerIterator LhsInnerIterator;
-  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const typename Res::Scalar& alpha)
+  typedef typename Res::Scalar Scalar;
+  enum {
+    // the number of columns of rhs multiplied per traversal of lhs
+    Tile = (Rhs::ColsAtCompileTime==Dynamic || Rhs::ColsAtCompileTime>8) ? 8 : Rhs::ColsAtCompileTime
+  };
+
+  // Computes the rows [begin,end) of the result. The columns go by tiles as long as possible: the
+  // coefficients of lhs are then loaded once for all the columns of a tile, whose sums stay in registers.
+  static void run_rows(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const Scalar& alpha, Index begin, Index end)
   {
-    for(Index c=0; c<rhs.cols(); ++c)
+    Index c0 = 0;
+    for(; Tile>1 && c0+Tile<=rhs.cols(); c0+=Tile)
+    {
+      for(Index j=begin; j<end; ++j)
+      {
+        Matrix<Scalar,1,Tile> tmp = Matrix<Scalar,1,Tile>::Zero();
+        for(LhsInnerIterator it(lhs,j); it ;++it)
+          tmp += it.value() * rhs.row(it.index()).template segment<Tile>(c0);
+        res.row(j).template segment<Tile>(c0) += alpha * tmp;
+      }
+    }
+    for(Index c=c0; c<rhs.cols(); ++c)
     {
-      int n = lhs.outerSize();
-      for(Index j=0; j<n; ++j)
+      for(Index j=begin; j<end; ++j)
       {
         typename Res::Scalar tmp(0);
         for(LhsInnerIterator it(lhs,j); it ;++it)
           tmp += it.value() * rhs.coeff(it.index(),c);
-        res.coeffRef(j,c) = alpha * tmp;
+        res.coeffRef(j,c) += alpha * tmp;
       }
     }
   }
+
+  struct task
+  {
+    void operator()(int i) const { run_rows(*lhs, *rhs, *res, alpha, bounds[i], bounds[i+1]); }
+    const SparseLhsType* lhs; const DenseRhsType* rhs; DenseResType* res;
+    Scalar alpha;
+    const Index* bounds;
+  };
+
+  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const Scalar& alpha)
+  {
+    // the rows are independent: each thread computes a range of them
+    const Index chunks = sparse_parallel_chunks(lhs, rhs.cols());
+    if(chunks==1)
+      return run_rows(lhs, rhs, res, alpha, 0, lhs.outerSize());
+
+    ei_declare_aligned_stack_constructed_variable(Index,bounds,(chunks+1),0);
+    sparse_balanced_outer_bounds(lhs, chunks, bounds);
+    task t;
+    t.lhs = &lhs; t.rhs = &rhs; t.res = &res;
+    t.alpha = alpha;
+    t.bounds = bounds;
+    parallel_run(int(chunks), t);
+  }
 };
 
 template<typename SparseLhsType, typename DenseRhsType, typename DenseResType>
@@ -174,11 +292,30 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, C
   typedef typename internal::remove_all<DenseResType>::type Res;
   typedef typename Lhs::InnerIterator LhsInnerIterator;
   typedef typename Lhs::Index Index;
-  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const typename Res::Scalar& alpha)
+  typedef typename Res::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,Dynamic> Buffer;
+  enum {
+    // the number of columns of rhs multiplied per traversal of lhs
+    Tile = (Rhs::ColsAtCompileTime==Dynamic || Rhs::ColsAtCompileTime>8) ? 8 : Rhs::ColsAtCompileTime
+  };
+
+  // Scatters the columns [begin,end) of lhs into dest, by tiles of columns of rhs as long as possible
+  template<typename Dest>
+  static void run_cols(const SparseLhsType& lhs, const DenseRhsType& rhs, Dest& res, const Scalar& alpha, Index begin, Index end)
   {
-    for(Index c=0; c<rhs.cols(); ++c)
+    Index c0 = 0;
+    for(; Tile>1 && c0+Tile<=rhs.cols(); c0+=Tile)
+    {
+      for(Index j=begin; j<end; ++j)
+      {
+        const Matrix<Scalar,1,Tile> rhs_j = alpha * rhs.row(j).template segment<Tile>(c0);
+        for(LhsInnerIterator it(lhs,j); it ;++it)
+          res.row(it.index()).template segment<Tile>(c0) += it.value() * rhs_j;
+      }
+    }
+    for(Index c=c0; c<rhs.cols(); ++c)
     {
-      for(Index j=0; j<lhs.outerSize(); ++j)
+      for(Index j=begin; j<end; ++j)
       {
         typename Res::Scalar rhs_j = alpha * rhs.coeff(j,c);
         for(LhsInnerIterator it(lhs,j); it ;++it)
@@ -186,6 +323,43 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, C
       }
     }
   }
+
+  // The first range of columns is scattered into the result, the i-th other one into the i-th buffer
+  struct task
+  {
+    void operator()(int i) const
+    {
+      if(i==0)
+        return run_cols(*lhs, *rhs, *res, alpha, bounds[0], bounds[1]);
+      Block<Buffer> buffer(*buffers, 0, (i-1)*rhs->cols(), buffers->rows(), rhs->cols());
+      buffer.setZero();
+      run_cols(*lhs, *rhs, buffer, alpha, bounds[i], bounds[i+1]);
+    }
+    const SparseLhsType* lhs; const DenseRhsType* rhs; DenseResType* res;
+    Scalar alpha;
+    const Index* bounds;
+    Buffer* buffers;
+  };
+
+  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const Scalar& alpha)
+  {
+    // each thread scatters a range of columns into its own buffer, the buffers being summed afterwards
+    const Index chunks = sparse_parallel_chunks(lhs, rhs.cols());
+    if(chunks==1)
+      return run_cols(lhs, rhs, res, alpha, 0, lhs.outerSize());
+
+    ei_declare_aligned_stack_constructed_variable(Index,bounds,(chunks+1),0);
+    sparse_balanced_outer_bounds(lhs, chunks, bounds);
+    Buffer buffers(res.rows(), (chunks-1)*res.cols());
+    task t;
+    t.lhs = &lhs; t.rhs = &rhs; t.res = &res;
+    t.alpha = alpha;
+    t.bounds = bounds;
+    t.buffers = &buffers;
+    parallel_run(int(chunks), t);
+
+    sparse_reduce_buffers(res, buffers, chunks-1);
+  }
 };
 
 template<typename SparseLhsType, typename DenseRhsType, typename DenseResType>
@@ -196,15 +370,45 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, R
   typedef typename internal::remove_all<DenseResType>::type Res;
   typedef typename Lhs::InnerIterator LhsInnerIterator;
   typedef typename Lhs::Index Index;
-  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const typename Res::Scalar& alpha)
+  typedef typename Res::Scalar Scalar;
+
+  // Computes the rows [begin,end) of the result, each of them being accumulated in a contiguous temporary
+  // whatever the storage order of the result
+  static void run_rows(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const Scalar& alpha, Index begin, Index end)
   {
-    for(Index j=0; j<lhs.outerSize(); ++j)
+    Matrix<Scalar,1,Rhs::ColsAtCompileTime,RowMajor,1,Rhs::MaxColsAtCompileTime> res_j;
+    res_j.resize(1, rhs.cols());
+    for(Index j=begin; j<end; ++j)
     {
-      typename Res::RowXpr res_j(res.row(j));
+      res_j.setZero();
       for(LhsInnerIterator it(lhs,j); it ;++it)
-        res_j += (alpha*it.value()) * rhs.row(it.index());
+        res_j += it.value() * rhs.row(it.index());
+      res.row(j) += alpha * res_j;
     }
   }
+
+  struct task
+  {
+    void operator()(int i) const { run_rows(*lhs, *rhs, *res, alpha, bounds[i], bounds[i+1]); }
+    const SparseLhsType* lhs; const DenseRhsType* rhs; DenseResType* res;
+    Scalar alpha;
+    const Index* bounds;
+  };
+
+  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const Scalar& alpha)
+  {
+    const Index chunks = sparse_parallel_chunks(lhs, rhs.cols());
+    if(chunks==1)
+      return run_rows(lhs, rhs, res, alpha, 0, lhs.outerSize());
+
+    ei_declare_aligned_stack_constructed_variable(Index,bounds,(chunks+1),0);
+    sparse_balanced_outer_bounds(lhs, chunks, bounds);
+    task t;
+    t.lhs = &lhs; t.rhs = &rhs; t.res = &res;
+    t.alpha = alpha;
+    t.bounds = bounds;
+    parallel_run(int(chunks), t);
+  }
 };
 
 template<typename SparseLhsType, typename DenseRhsType, typename DenseResType>
@@ -215,15 +419,56 @@ struct sparse_time_dense_product_impl<SparseLhsType,DenseRhsType,DenseResType, C
   typedef typename internal::remove_all<DenseResType>::type Res;
   typedef typename Lhs::InnerIterator LhsInnerIterator;
   typedef typename Lhs::Index Index;
-  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const typename Res::Scalar& alpha)
+  typedef typename Res::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,Dynamic,RowMajor> Buffer;
+
+  // Scatters the rows [begin,end) of rhs into dest
+  template<typename Dest>
+  static void run_cols(const SparseLhsType& lhs, const DenseRhsType& rhs, Dest& res, const Scalar& alpha, Index begin, Index end)
   {
-    for(Index j=0; j<lhs.outerSize(); ++j)
+    for(Index j=begin; j<end; ++j)
     {
       typename Rhs::ConstRowXpr rhs_j(rhs.row(j));
       for(LhsInnerIterator it(lhs,j); it ;++it)
         res.row(it.index()) += (alpha*it.value()) * rhs_j;
     }
   }
+
+  // The i-th range of columns of lhs is scattered into the i-th buffer
+  struct task
+  {
+    void operator()(int i) const
+    {
+      Block<Buffer> buffer(*buffers, 0, i*rhs->cols(), buffers->rows(), rhs->cols());
+      buffer.setZero();
+      run_cols(*lhs, *rhs, buffer, alpha, bounds[i], bounds[i+1]);
+    }
+    const SparseLhsType* lhs; const DenseRhsType* rhs;
+    Scalar alpha;
+    const Index* bounds;
+    Buffer* buffers;
+  };
+
+  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const Scalar& alpha)
+  {
+    // the rows of rhs are scattered into any rows of the result: each thread scatters a range of them into
+    // its own row-major buffer, the buffers being summed afterwards
+    const Index chunks = sparse_parallel_chunks(lhs, rhs.cols());
+    if(chunks==1)
+      return run_cols(lhs, rhs, res, alpha, 0, lhs.outerSize());
+
+    ei_declare_aligned_stack_constructed_variable(Index,bounds,(chunks+1),0);
+    sparse_balanced_outer_bounds(lhs, chunks, bounds);
+    Buffer buffers(res.rows(), chunks*res.cols());
+    task t;
+    t.lhs = &lhs; t.rhs = &rhs;
+    t.alpha = alpha;
+    t.bounds = bounds;
+    t.buffers = &buffers;
+    parallel_run(int(chunks), t);
+
+    sparse_reduce_buffers(res, buffers, chunks);
+  }
 };
 
 template<typename SparseLhsType, typename DenseRhsType, typename DenseResType,typename AlphaType>
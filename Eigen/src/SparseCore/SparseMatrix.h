@@ -428,7 +428,13 @@ class SparseMatrix
     template<typename InputIterators>
     void setFromTriplets(const InputIterators& begin, const InputIterators& end);
 
-    void sumupDuplicates();
+    template<typename InputIterators,typename DupFunctor>
+    void setFromTriplets(const InputIterators& begin, const InputIterators& end, DupFunctor dup_func);
+
+    void sumupDuplicates() { collapseDuplicates(internal::scalar_sum_op<Scalar>()); }
+
+    template<typename DupFunctor>
+    void collapseDuplicates(DupFunctor dup_func = DupFunctor());
 
     //---
     
@@ -1091,13 +1097,200 @@ class SparseMatrix<Scalar,_Options,_Index>::ReverseInnerIterator
 
 namespace internal {
 
-template<typename InputIterator, typename SparseMatrixType>
-void set_from_triplets(const InputIterator& begin, const InputIterator& end, SparseMatrixType& mat, int Options = 0)
+// Orders the (inner index, value) pairs of an outer vector by inner index
+template<typename Index, typename Scalar> struct triplet_inner_less
+{
+  bool operator()(const std::pair<Index,Scalar>& a, const std::pair<Index,Scalar>& b) const { return a.first < b.first; }
+};
+
+/** \internal Multithreaded assembly of a random access range of triplets. The range is split into
+  * one contiguous piece per thread, and the triplets are counting sorted by outer index straight
+  * into the storage order of the result:
+  *  - each thread counts the nonzeros per outer vector of its own piece into its own column of \c offsets,
+  *  - a prefix sum turns the counts into the position of each piece within each outer vector,
+  *    so that the triplets of an outer vector stay in their input order,
+  *  - each thread scatters its piece, then each thread sorts and combines the duplicates of a range
+  *    of outer vectors, holding about the same number of triplets, in place,
+  *  - the combined outer vectors are copied into the compressed storage of the result.
+  */
+template<typename InputIterator, typename SparseMatrixType, typename DupFunctor>
+struct triplets_assembly
 {
-  EIGEN_UNUSED_VARIABLE(Options);
-  enum { IsRowMajor = SparseMatrixType::IsRowMajor };
   typedef typename SparseMatrixType::Scalar Scalar;
   typedef typename SparseMatrixType::Index Index;
+  typedef std::pair<Index,Scalar> Entry;
+  enum { IsRowMajor = SparseMatrixType::IsRowMajor };
+
+  triplets_assembly(const InputIterator& begin, Index count, int chunks, SparseMatrixType& mat, const DupFunctor& dup_func)
+    : m_begin(begin), m_count(count), m_chunks(chunks), m_mat(mat), m_dup_func(dup_func), m_pass(0),
+      m_offsets(mat.outerSize(), chunks), m_starts(mat.outerSize()+1), m_nonZeros(mat.outerSize()),
+      m_inner(count), m_values(count)
+  {}
+
+  void run()
+  {
+    m_pass = 0;
+    parallel_run(m_chunks, *this);
+
+    Index pos = 0;
+    for(Index j=0; j<m_mat.outerSize(); ++j)
+    {
+      m_starts[j] = pos;
+      for(int t=0; t<m_chunks; ++t)
+      {
+        Index n = m_offsets(j,t);
+        m_offsets(j,t) = pos;
+        pos += n;
+      }
+    }
+    m_starts[m_mat.outerSize()] = pos;
+
+    m_pass = 1;
+    parallel_run(m_chunks, *this);
+    m_pass = 2;
+    parallel_run(m_chunks, *this);
+
+    m_mat.resize(m_mat.rows(), m_mat.cols());
+    Index* outerIndex = m_mat.outerIndexPtr();
+    for(Index j=0; j<m_mat.outerSize(); ++j)
+      outerIndex[j+1] = outerIndex[j] + m_nonZeros[j];
+    m_mat.data().resize(outerIndex[m_mat.outerSize()]);
+
+    m_pass = 3;
+    parallel_run(m_chunks, *this);
+  }
+
+  void operator()(int i) const
+  {
+    if(m_pass==0)
+      count(i);
+    else if(m_pass==1)
+      scatter(i);
+    else if(m_pass==2)
+      collapse(i);
+    else
+      copy(i);
+  }
+
+  // pass 1: the nnz per outer vector of the i-th piece
+  void count(int i) const
+  {
+    Index* counts = &m_offsets.coeffRef(0,i);
+    std::fill(counts, counts+m_mat.outerSize(), Index(0));
+    InputIterator end = m_begin + pieceStart(i+1);
+    for(InputIterator it = m_begin + pieceStart(i); it!=end; ++it)
+    {
+      eigen_assert(it->row()>=0 && it->row()<m_mat.rows() && it->col()>=0 && it->col()<m_mat.cols());
+      ++counts[IsRowMajor ? it->row() : it->col()];
+    }
+  }
+
+  // pass 2: the triplets of the i-th piece are scattered to their outer vectors
+  void scatter(int i) const
+  {
+    Index* offsets = &m_offsets.coeffRef(0,i);
+    InputIterator end = m_begin + pieceStart(i+1);
+    for(InputIterator it = m_begin + pieceStart(i); it!=end; ++it)
+    {
+      Index p = offsets[IsRowMajor ? it->row() : it->col()]++;
+      m_inner[p] = IsRowMajor ? it->col() : it->row();
+      m_values[p] = it->value();
+    }
+  }
+
+  // pass 3: the i-th range of outer vectors is sorted and its duplicates are combined in place
+  void collapse(int i) const
+  {
+    std::vector<Entry> buffer;
+    Index last = outerRangeStart(i+1);
+    for(Index j=outerRangeStart(i); j<last; ++j)
+    {
+      Index start = m_starts[j], end = m_starts[j+1];
+      if(end-start<=16)
+      {
+        // stable insertion sort of the short outer vectors
+        for(Index k=start+1; k<end; ++k)
+        {
+          Index inner = m_inner[k];
+          Scalar value = m_values[k];
+          Index l = k;
+          for(; l>start && m_inner[l-1]>inner; --l)
+          {
+            m_inner[l] = m_inner[l-1];
+            m_values[l] = m_values[l-1];
+          }
+          m_inner[l] = inner;
+          m_values[l] = value;
+        }
+      }
+      else
+      {
+        buffer.resize(end-start);
+        for(Index k=start; k<end; ++k)
+          buffer[k-start] = Entry(m_inner[k], m_values[k]);
+        std::stable_sort(buffer.begin(), buffer.end(), triplet_inner_less<Index,Scalar>());
+        for(Index k=start; k<end; ++k)
+        {
+          m_inner[k] = buffer[k-start].first;
+          m_values[k] = buffer[k-start].second;
+        }
+      }
+
+      Index dst = start;
+      for(Index k=start; k<end; ++k)
+      {
+        if(dst>start && m_inner[dst-1]==m_inner[k])
+          m_values[dst-1] = m_dup_func(m_values[dst-1], m_values[k]);
+        else
+        {
+          m_inner[dst] = m_inner[k];
+          m_values[dst] = m_values[k];
+          ++dst;
+        }
+      }
+      m_nonZeros[j] = dst-start;
+    }
+  }
+
+  // pass 4: copy of the i-th range of outer vectors into the compressed storage
+  void copy(int i) const
+  {
+    const Index* outerIndex = m_mat.outerIndexPtr();
+    Index last = outerRangeStart(i+1);
+    for(Index j=outerRangeStart(i); j<last; ++j)
+    {
+      std::copy(&m_inner[m_starts[j]], &m_inner[m_starts[j]]+m_nonZeros[j], m_mat.innerIndexPtr()+outerIndex[j]);
+      std::copy(&m_values[m_starts[j]], &m_values[m_starts[j]]+m_nonZeros[j], m_mat.valuePtr()+outerIndex[j]);
+    }
+  }
+
+  Index pieceStart(int i) const { return Index((double(m_count)*i)/m_chunks); }
+
+  // the first outer vector of the i-th range, the ranges holding about the same number of triplets
+  Index outerRangeStart(int i) const
+  {
+    if(i==m_chunks)
+      return m_mat.outerSize();
+    return Index(std::lower_bound(&m_starts[0], &m_starts[0]+m_mat.outerSize(), pieceStart(i)) - &m_starts[0]);
+  }
+
+  InputIterator m_begin;
+  Index m_count;
+  int m_chunks;
+  SparseMatrixType& m_mat;
+  DupFunctor m_dup_func;
+  int m_pass;
+  mutable Matrix<Index,Dynamic,Dynamic> m_offsets;
+  mutable Matrix<Index,Dynamic,1> m_starts, m_nonZeros, m_inner;
+  mutable Matrix<Scalar,Dynamic,1> m_values;
+};
+
+template<typename InputIterator, typename SparseMatrixType, typename DupFunctor>
+void set_from_triplets(const InputIterator& begin, const InputIterator& end, SparseMatrixType& mat, DupFunctor dup_func,
+                       std::input_iterator_tag)
+{
+  enum { IsRowMajor = SparseMatrixType::IsRowMajor };
+  typedef typename SparseMatrixType::Scalar Scalar;
   SparseMatrix<Scalar,IsRowMajor?ColMajor:RowMajor> trMat(mat.rows(),mat.cols());
 
   // pass 1: count the nnz per inner-vector
@@ -1112,12 +1305,31 @@ void set_from_triplets(const InputIterator& begin, const InputIterator& end, Spa
     trMat.insertBackUncompressed(it->row(),it->col()) = it->value();
 
   // pass 3:
-  trMat.sumupDuplicates();
+  trMat.collapseDuplicates(dup_func);
 
   // pass 4: transposed copy -> implicit sorting
   mat = trMat;
 }
 
+template<typename InputIterator, typename SparseMatrixType, typename DupFunctor>
+void set_from_triplets(const InputIterator& begin, const InputIterator& end, SparseMatrixType& mat, DupFunctor dup_func,
+                       std::random_access_iterator_tag)
+{
+  typedef typename SparseMatrixType::Index Index;
+  Index count = Index(end - begin);
+  int chunks = int(parallel_chunks(count, Index(EIGEN_PARALLEL_TRIPLETS_THRESHOLD)));
+  if(chunks==1)
+    set_from_triplets(begin, end, mat, dup_func, std::input_iterator_tag());
+  else
+    triplets_assembly<InputIterator,SparseMatrixType,DupFunctor>(begin, count, chunks, mat, dup_func).run();
+}
+
+template<typename InputIterator, typename SparseMatrixType, typename DupFunctor>
+void set_from_triplets(const InputIterator& begin, const InputIterator& end, SparseMatrixType& mat, DupFunctor dup_func)
+{
+  set_from_triplets(begin, end, mat, dup_func, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+
 }
 
 
@@ -1127,6 +1339,9 @@ void set_from_triplets(const InputIterator& begin, const InputIterator& end, Spa
   * The input list of triplets does not have to be sorted, and can contains duplicated elements.
   * In any case, the result is a \b sorted and \b compressed sparse matrix where the duplicates have been summed up.
   * This is a \em O(n) operation, with \em n the number of triplet elements.
+  * When the iterators are random access and the list is long enough (see EIGEN_PARALLEL_TRIPLETS_THRESHOLD),
+  * the triplets are counted, scattered and combined among the threads.
+  * The duplicates are combined in the order of the list whatever the number of threads.
   * The initial contents of \c *this is destroyed.
   * The matrix \c *this must be properly resized beforehand using the SparseMatrix(Index,Index) constructor,
   * or the resize(Index,Index) method. The sizes are not extracted from the triplet list.
@@ -1162,12 +1377,29 @@ template<typename Scalar, int _Options, typename _Index>
 template<typename InputIterators>
 void SparseMatrix<Scalar,_Options,_Index>::setFromTriplets(const InputIterators& begin, const InputIterators& end)
 {
-  internal::set_from_triplets(begin, end, *this);
+  internal::set_from_triplets(begin, end, *this, internal::scalar_sum_op<Scalar>());
+}
+
+/** The same as setFromTriplets but when duplicates are met the functor \a dup_func is applied:
+  * \code
+  * value = dup_func(OldValue, NewValue)
+  * \endcode
+  * Here is a C++11 example keeping the latest entry only:
+  * \code
+  * mat.setFromTriplets(triplets.begin(), triplets.end(), [] (const Scalar&,const Scalar &b) { return b; });
+  * \endcode
+  */
+template<typename Scalar, int _Options, typename _Index>
+template<typename InputIterators,typename DupFunctor>
+void SparseMatrix<Scalar,_Options,_Index>::setFromTriplets(const InputIterators& begin, const InputIterators& end, DupFunctor dup_func)
+{
+  internal::set_from_triplets(begin, end, *this, dup_func);
 }
 
 /** \internal */
 template<typename Scalar, int _Options, typename _Index>
-void SparseMatrix<Scalar,_Options,_Index>::sumupDuplicates()
+template<typename DupFunctor>
+void SparseMatrix<Scalar,_Options,_Index>::collapseDuplicates(DupFunctor dup_func)
 {
   eigen_assert(!isCompressed());
   // TODO, in practice we should be able to use m_innerNonZeros for that task
@@ -1185,7 +1417,7 @@ void SparseMatrix<Scalar,_Options,_Index>::sumupDuplicates()
       if(wi(i)>=start)
       {
         // we already meet this entry => accumulate it
-        m_data.value(wi(i)) += m_data.value(k);
+        m_data.value(wi(i)) = dup_func(m_data.value(wi(i)), m_data.value(k));
       }
       else
       {
@@ -195,8 +195,101 @@ struct traits<SparseSelfAdjointTimeDenseProduct<Lhs,Rhs,UpLo> >
 {
   typedef Dense StorageKind;
 };
+
+template<int UpLo, typename SparseLhsType, typename DenseRhsType, typename DenseResType>
+struct sparse_selfadjoint_time_dense_product_impl
+{
+  typedef typename internal::remove_all<SparseLhsType>::type Lhs;
+  typedef typename Lhs::InnerIterator LhsInnerIterator;
+  typedef typename Lhs::Index Index;
+  typedef typename DenseResType::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,Dynamic> Buffer;
+  enum {
+    LhsIsRowMajor = (Lhs::Flags&RowMajorBit)==RowMajorBit,
+    ProcessFirstHalf =
+             ((UpLo&(Upper|Lower))==(Upper|Lower))
+          || ( (UpLo&Upper) && !LhsIsRowMajor)
+          || ( (UpLo&Lower) && LhsIsRowMajor),
+    ProcessSecondHalf = !ProcessFirstHalf
+  };
+
+  // Adds the contributions of the stored triangle of the outer vectors [begin,end) of lhs to dest,
+  // each off-diagonal coefficient updating two rows of dest
+  template<typename Dest>
+  static void run_outer(const SparseLhsType& lhs, const DenseRhsType& rhs, Dest& dest, const Scalar& alpha, Index begin, Index end)
+  {
+    for (Index j=begin; j<end; ++j)
+    {
+      LhsInnerIterator i(lhs,j);
+      if (ProcessSecondHalf)
+      {
+        while (i && i.index()<j) ++i;
+        if(i && i.index()==j)
+        {
+          dest.row(j) += (alpha*i.value()) * rhs.row(j);
+          ++i;
+        }
+      }
+      for(; (ProcessFirstHalf ? i && i.index() < j : i) ; ++i)
+      {
+        Index a = LhsIsRowMajor ? j : i.index();
+        Index b = LhsIsRowMajor ? i.index() : j;
+        typename Lhs::Scalar v = i.value();
+        dest.row(a) += (alpha*v) * rhs.row(b);
+        dest.row(b) += (alpha*internal::conj(v)) * rhs.row(a);
+      }
+      if (ProcessFirstHalf && i && (i.index()==j))
+        dest.row(j) += (alpha*i.value()) * rhs.row(j);
+    }
+  }
+
+  // The first range of outer vectors is processed into the result, the i-th other one into the i-th buffer
+  struct task
+  {
+    void operator()(int i) const
+    {
+      if(i==0)
+        return run_outer(*lhs, *rhs, *res, alpha, bounds[0], bounds[1]);
+      Block<Buffer> buffer(*buffers, 0, (i-1)*rhs->cols(), buffers->rows(), rhs->cols());
+      buffer.setZero();
+      run_outer(*lhs, *rhs, buffer, alpha, bounds[i], bounds[i+1]);
+    }
+    const SparseLhsType* lhs; const DenseRhsType* rhs; DenseResType* res;
+    Scalar alpha;
+    const Index* bounds;
+    Buffer* buffers;
+  };
+
+  static void run(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const Scalar& alpha)
+  {
+    // a stored coefficient updates a row of the result out of the range of its thread too: each thread
+    // accumulates into its own buffer, the buffers being summed afterwards
+    const Index chunks = sparse_parallel_chunks(lhs, Index(rhs.cols()));
+    if(chunks==1)
+      return run_outer(lhs, rhs, res, alpha, 0, lhs.outerSize());
+
+    ei_declare_aligned_stack_constructed_variable(Index,bounds,(chunks+1),0);
+    sparse_balanced_outer_bounds(lhs, chunks, bounds);
+    Buffer buffers(res.rows(), (chunks-1)*res.cols());
+    task t;
+    t.lhs = &lhs; t.rhs = &rhs; t.res = &res;
+    t.alpha = alpha;
+    t.bounds = bounds;
+    t.buffers = &buffers;
+    parallel_run(int(chunks), t);
+
+    sparse_reduce_buffers(res, buffers, chunks-1);
+  }
+};
+
+template<int UpLo, typename SparseLhsType, typename DenseRhsType, typename DenseResType, typename AlphaType>
+inline void sparse_selfadjoint_time_dense_product(const SparseLhsType& lhs, const DenseRhsType& rhs, DenseResType& res, const AlphaType& alpha)
+{
+  sparse_selfadjoint_time_dense_product_impl<UpLo,SparseLhsType,DenseRhsType,DenseResType>::run(lhs, rhs, res, alpha);
 }
 
+} // end namespace internal
+
 template<typename Lhs, typename Rhs, int UpLo>
 class SparseSelfAdjointTimeDenseProduct
   : public ProductBase<SparseSelfAdjointTimeDenseProduct<Lhs,Rhs,UpLo>, Lhs, Rhs>
@@ -209,43 +302,7 @@ class SparseSelfAdjointTimeDenseProduct
 
     template<typename Dest> void scaleAndAddTo(Dest& dest, const Scalar& alpha) const
     {
-      EIGEN_ONLY_USED_FOR_DEBUG(alpha);
-      // TODO use alpha
-      eigen_assert(alpha==Scalar(1) && "alpha != 1 is not implemented yet, sorry");
-      typedef typename internal::remove_all<Lhs>::type _Lhs;
-      typedef typename internal::remove_all<Rhs>::type _Rhs;
-      typedef typename _Lhs::InnerIterator LhsInnerIterator;
-      enum {
-        LhsIsRowMajor = (_Lhs::Flags&RowMajorBit)==RowMajorBit,
-        ProcessFirstHalf =
-                 ((UpLo&(Upper|Lower))==(Upper|Lower))
-              || ( (UpLo&Upper) && !LhsIsRowMajor)
-              || ( (UpLo&Lower) && LhsIsRowMajor),
-        ProcessSecondHalf = !ProcessFirstHalf
-      };
-      for (Index j=0; j<m_lhs.outerSize(); ++j)
-      {
-        LhsInnerIterator i(m_lhs,j);
-        if (ProcessSecondHalf)
-        {
-          while (i && i.index()<j) ++i;
-          if(i && i.index()==j)
-          {
-            dest.row(j) += i.value() * m_rhs.row(j);
-            ++i;
-          }
-        }
-        for(; (ProcessFirstHalf ? i && i.index() < j : i) ; ++i)
-        {
-          Index a = LhsIsRowMajor ? j : i.index();
-          Index b = LhsIsRowMajor ? i.index() : j;
-          typename Lhs::Scalar v = i.value();
-          dest.row(a) += (v) * m_rhs.row(b);
-          dest.row(b) += internal::conj(v) * m_rhs.row(a);
-        }
-        if (ProcessFirstHalf && i && (i.index()==j))
-          dest.row(j) += i.value() * m_rhs.row(j);
-      }
+      internal::sparse_selfadjoint_time_dense_product<UpLo>(m_lhs, m_rhs, dest, alpha);
     }
 
   private:
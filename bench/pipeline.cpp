@@ -0,0 +1,298 @@
+/*
+  Benchmark of the hamiltonian -> eigensolver -> observables pipeline.
+
+  For every phonon cutoff of the grid (n_ir = n_R = n) this runs, in a scratch
+  directory:
+
+    hamiltonian    3-sites-linear/hamiltonian (assembly and writing of hamiltonian.txt)
+    eig/t<n>       eig --profile hamiltonian.txt with OMP_NUM_THREADS=n, once per thread
+                   count, and the phases of its profile: eig/t<n>/read, tridiagonalize,
+                   back-transform, QR and write
+    mean_phonons   3-sites-linear/mean-phonons
+
+  and reports wall time, GFLOP/s (for the eigensolver phases of eig, counting 9n^3
+  flops) and peak RSS of each phase as JSON. The "timings" object of the report is a flat map from
+  "n<cutoff>/<phase>" to seconds; --baseline compares it against a previous report and
+  fails if a phase got slower than the tolerance.
+
+  usage: pipeline [--grid list] [--threads list] [--output file]
+                  [--baseline file] [--tolerance fraction]
+         where lists are comma separated values or ranges first:last:step.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <Eigen/Core>
+
+using namespace std;
+using namespace Eigen;
+
+struct Phase {
+  string name;
+  double seconds;
+  double gflops;  // 0 when it does not apply
+  long peak_rss_kb;
+};
+
+double now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// Parses "2,4,8" or "2:40:2" (or a mix of both)
+vector<int> parse_list(const char *text) {
+  vector<int> values;
+  stringstream ss(text);
+  string item;
+  while (getline(ss, item, ',')) {
+    int first, last, step = 1;
+    int fields = sscanf(item.c_str(), "%d:%d:%d", &first, &last, &step);
+    if (fields == 1)
+      values.push_back(first);
+    else if (fields >= 2 && step > 0)
+      for (int v = first; v <= last; v += step)
+	values.push_back(v);
+  }
+  return values;
+}
+
+// Runs "program" with the arguments "args" in "dir", with OMP_NUM_THREADS set to
+// "threads" when it is positive, and measures its wall time and peak RSS
+bool run(const string &program, const vector<string> &args, int threads, const string &dir, Phase &phase) {
+  vector<char *> argv(1, const_cast<char *>(program.c_str()));
+  for (size_t a = 0; a < args.size(); a++)
+    argv.push_back(const_cast<char *>(args[a].c_str()));
+  argv.push_back(NULL);
+  char omp_threads[32];
+  snprintf(omp_threads, sizeof(omp_threads), "%d", threads);
+
+  double start = now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    if (chdir(dir.c_str()) != 0)
+      _exit(127);
+    if (!freopen("/dev/null", "w", stdout))
+      _exit(127);
+    if (threads > 0)
+      setenv("OMP_NUM_THREADS", omp_threads, 1);
+    execv(program.c_str(), &argv[0]);
+    _exit(127);
+  }
+  int status;
+  struct rusage usage;
+  if (pid < 0 || wait4(pid, &status, 0, &usage) != pid)
+    return false;
+  phase.seconds = now() - start;
+  phase.gflops = 0;
+  phase.peak_rss_kb = usage.ru_maxrss;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void write_parameters(const string &dir, int cutoff) {
+  ofstream paramfile((dir + "/parameters.inp").c_str());
+  paramfile << "0.5, Band energy for site 1" << endl;
+  paramfile << "-0.5, Band energy for site 2" << endl;
+  paramfile << "0.5, Band energy for site 3" << endl;
+  paramfile << "-1.0, Nearest neighbor hopping" << endl;
+  paramfile << "2.0, On site Coulomb repulsion" << endl;
+  paramfile << "0.3, Infrared phonon's energy" << endl;
+  paramfile << "0.2, Electron - infrared phonons coupling" << endl;
+  paramfile << "0.4, Raman phonon's energy" << endl;
+  paramfile << "0.1, Electron - raman phonons coupling" << endl;
+  paramfile << "1.0, Raman shift" << endl;
+  paramfile << cutoff << ", Number of infrared phonons" << endl;
+  paramfile << cutoff << ", Number of raman phonons" << endl;
+}
+
+// Reads the phases of a report written by profile::report(), e.g. "eig.profile.json"
+bool read_profile(const string &filename, vector<Phase> &phases) {
+  ifstream infile(filename.c_str());
+  string text((istreambuf_iterator<char>(infile)), istreambuf_iterator<char>());
+  if (!infile)
+    return false;
+  size_t pos = 0;
+  while ((pos = text.find("\"phase\": \"", pos)) != string::npos) {
+    Phase phase;
+    pos += 10;
+    phase.name = text.substr(pos, text.find('"', pos) - pos);
+    size_t wall = text.find("\"wall_s\":", pos), rss = text.find("\"peak_rss_kb\":", pos);
+    if (wall == string::npos || rss == string::npos)
+      return false;
+    phase.seconds = atof(text.c_str() + wall + 9);
+    phase.gflops = 0;
+    phase.peak_rss_kb = atol(text.c_str() + rss + 14);
+    phases.push_back(phase);
+  }
+  return true;
+}
+
+// Benchmarks one cutoff, appending its phases to "phases"
+bool bench_cutoff(const string &root, int cutoff, const vector<int> &threads, vector<Phase> &phases) {
+  char dir[] = "/tmp/bench-pipeline.XXXXXX";
+  if (mkdtemp(dir) == NULL)
+    return false;
+  write_parameters(dir, cutoff);
+  int size = 9 * (1 + cutoff) * (1 + cutoff);
+  Phase phase;
+  bool ok;
+
+  phase.name = "hamiltonian";
+  if ((ok = run(root + "/3-sites-linear/hamiltonian", vector<string>(), 0, dir, phase)))
+    phases.push_back(phase);
+
+  // eig itself, so the benchmark follows its code path (reading, the staged
+  // tridiagonalization and QR, writing); the last run leaves eigenvectors.txt
+  // for mean-phonons
+  vector<string> args;
+  args.push_back("--profile");
+  args.push_back("hamiltonian.txt");
+  for (size_t t = 0; ok && t < threads.size(); t++) {
+    stringstream name;
+    name << "eig/t" << threads[t];
+    phase.name = name.str();
+    vector<Phase> eig_phases;
+    if (!(ok = run(root + "/eig", args, threads[t], dir, phase) &&
+	  read_profile(string(dir) + "/eig.profile.json", eig_phases)))
+      break;
+    double solver_seconds = 0;
+    for (size_t p = 0; p < eig_phases.size(); p++) {
+      const string &n = eig_phases[p].name;
+      if (n == "tridiagonalize" || n == "back-transform" || n == "QR")
+	solver_seconds += eig_phases[p].seconds;
+    }
+    if (solver_seconds > 0)
+      phase.gflops = 9.0 * size * size * (double) size / solver_seconds * 1e-9;
+    phases.push_back(phase);
+    for (size_t p = 0; p < eig_phases.size(); p++) {
+      eig_phases[p].name = name.str() + "/" + eig_phases[p].name;
+      phases.push_back(eig_phases[p]);
+    }
+  }
+  phase.gflops = 0;
+
+  phase.name = "mean_phonons";
+  if (ok && (ok = run(root + "/3-sites-linear/mean-phonons", vector<string>(), 0, dir, phase)))
+    phases.push_back(phase);
+
+  string cleanup = string("rm -rf ") + dir;
+  if (system(cleanup.c_str()) != 0)
+    cout << "Unable to remove " << dir << endl;
+  return ok;
+}
+
+// Reads the flat "timings" object of a previous report
+bool read_timings(const char *filename, map<string, double> &timings) {
+  ifstream infile(filename);
+  string text((istreambuf_iterator<char>(infile)), istreambuf_iterator<char>());
+  size_t pos = text.find("\"timings\"");
+  if (!infile || pos == string::npos)
+    return false;
+  size_t end = text.find('}', pos);
+  pos = text.find('{', pos);
+  while ((pos = text.find('"', pos + 1)) < end) {
+    size_t close = text.find('"', pos + 1);
+    string key = text.substr(pos + 1, close - pos - 1);
+    pos = text.find(':', close);
+    timings[key] = atof(text.c_str() + pos + 1);
+  }
+  return true;
+}
+
+int main (int argc, char *argv[]) {
+  vector<int> grid = parse_list("2,4,6,8");
+  vector<int> threads(1, 1);
+  const char *output = "bench-results.json", *baseline = NULL;
+  double tolerance = 0.1;
+  string root = ".";
+
+  for (int n = 2; n <= (int) sysconf(_SC_NPROCESSORS_ONLN); n *= 2)
+    threads.push_back(n);
+
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--grid") == 0 && arg + 1 < argc)
+      grid = parse_list(argv[++arg]);
+    else if (strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc)
+      threads = parse_list(argv[++arg]);
+    else if (strcmp(argv[arg], "--output") == 0 && arg + 1 < argc)
+      output = argv[++arg];
+    else if (strcmp(argv[arg], "--baseline") == 0 && arg + 1 < argc)
+      baseline = argv[++arg];
+    else if (strcmp(argv[arg], "--tolerance") == 0 && arg + 1 < argc)
+      tolerance = atof(argv[++arg]);
+    else {
+      cout << "usage: pipeline [--grid list] [--threads list] [--output file]\n"
+	   << "                [--baseline file] [--tolerance fraction]\n"
+	   << "       where lists are comma separated values or ranges first:last:step." << endl;
+      return 1;
+    }
+  }
+
+  char path[4096];
+  if (realpath(root.c_str(), path))
+    root = path;
+
+  ofstream report(output);
+  map<string, double> timings;
+  report << "{\n  \"eigen_version\": \"" << EIGEN_WORLD_VERSION << "." << EIGEN_MAJOR_VERSION
+	 << "." << EIGEN_MINOR_VERSION << "\",\n  \"simd\": \"" << SimdInstructionSetsInUse()
+	 << "\",\n  \"results\": [";
+  for (size_t g = 0; g < grid.size(); g++) {
+    vector<Phase> phases;
+    cout << "Cutoff " << grid[g] << " (size " << 9 * (1 + grid[g]) * (1 + grid[g]) << ")... " << flush;
+    bool ok = bench_cutoff(root, grid[g], threads, phases);
+    cout << (ok ? "Done." : "Failed.") << endl;
+
+    report << (g ? "," : "") << "\n    {\"n_ir\": " << grid[g] << ", \"n_r\": " << grid[g]
+	   << ", \"size\": " << 9 * (1 + grid[g]) * (1 + grid[g]) << ", \"ok\": " << (ok ? "true" : "false")
+	   << ", \"phases\": [";
+    for (size_t p = 0; p < phases.size(); p++) {
+      stringstream key;
+      key << "n" << grid[g] << "/" << phases[p].name;
+      timings[key.str()] = phases[p].seconds;
+      report << (p ? "," : "") << "\n      {\"phase\": \"" << phases[p].name << "\", \"wall_s\": "
+	     << phases[p].seconds << ", \"gflops\": " << phases[p].gflops
+	     << ", \"peak_rss_kb\": " << phases[p].peak_rss_kb << "}";
+    }
+    report << "]}";
+  }
+  report << "\n  ],\n  \"timings\": {";
+  for (map<string, double>::iterator t = timings.begin(); t != timings.end(); ++t)
+    report << (t == timings.begin() ? "" : ",") << "\n    \"" << t->first << "\": " << t->second;
+  report << "\n  }\n}\n";
+  report.close();
+  cout << "Saved the report at \"" << output << "\"." << endl;
+
+  if (baseline == NULL)
+    return 0;
+
+  map<string, double> previous;
+  if (!read_timings(baseline, previous)) {
+    cout << "I couldn't read the baseline: " << baseline << endl;
+    return 1;
+  }
+  int regressions = 0;
+  printf("%-28s %12s %12s %8s\n", "phase", "baseline [s]", "current [s]", "ratio");
+  for (map<string, double>::iterator t = timings.begin(); t != timings.end(); ++t) {
+    if (previous.count(t->first) == 0 || previous[t->first] <= 0)
+      continue;
+    double ratio = t->second / previous[t->first];
+    bool slower = ratio > 1 + tolerance;
+    regressions += slower;
+    printf("%-28s %12.4g %12.4g %8.3f%s\n", t->first.c_str(), previous[t->first], t->second, ratio,
+	   slower ? "  REGRESSION" : "");
+  }
+  return regressions ? 2 : 0;
+}
@@ -0,0 +1,201 @@
+/*
+  Benchmark of the sparse hamiltonian times a block of k vectors, the kernel of the block
+  eigensolvers (block Lanczos, Davidson, LOBPCG).
+
+  For every phonon cutoff of the grid (n_ir = n_R = n) this assembles the hamiltonian of
+  3-sites-linear/hamiltonian as a SparseMatrix and, for every block size k and thread count,
+  times
+
+    spmv    k products by a single vector, one column after the other
+    spmm    one product by the k vectors at once
+
+  and reports the time per product, the GFLOP/s (2 flops per nonzero and vector) and the
+  achieved bandwidth as JSON. The bandwidth counts the bytes a product has to move at least:
+  the values and indices of the matrix once per traversal, the vectors read and the result
+  written, so spmm moves fewer bytes than spmv for the same work.
+
+  usage: spmm [--grid list] [--vectors list] [--threads list] [--repeat count] [--output file]
+         where lists are comma separated values or ranges first:last:step.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <Eigen/Sparse>
+#include <Eigen/Dense>
+#include "3-sites-linear/model.h"
+
+using namespace std;
+using namespace Eigen;
+
+typedef SparseMatrix<double, RowMajor> SpMat;
+
+double now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// Parses "2,4,8" or "2:40:2" (or a mix of both)
+vector<int> parse_list(const char *text) {
+  vector<int> values;
+  stringstream ss(text);
+  string item;
+  while (getline(ss, item, ',')) {
+    int first, last, step = 1;
+    int fields = sscanf(item.c_str(), "%d:%d:%d", &first, &last, &step);
+    if (fields == 1)
+      values.push_back(first);
+    else if (fields >= 2 && step > 0)
+      for (int v = first; v <= last; v += step)
+	values.push_back(v);
+  }
+  return values;
+}
+
+// Sums the contributions of hamiltonian_elements into a list of triplets
+struct triplet_adder {
+  vector<Triplet<double> > &entries;
+  triplet_adder(vector<Triplet<double> > &e) : entries(e) {}
+  void operator() (int row, int col, double value) { entries.push_back(Triplet<double>(row, col, value)); }
+};
+
+// The hamiltonian of 3-sites-linear/hamiltonian with the parameters of bench/pipeline
+void build_hamiltonian(int cutoff, SpMat &h) {
+  model_parameters p;
+  p.band_energy[0] = 0.5;
+  p.band_energy[1] = -0.5;
+  p.band_energy[2] = 0.5;
+  p.nn_hopping = -1.0;
+  p.on_site_repulsion = 2.0;
+  p.ir_energy = 0.3;
+  p.e_ir_coupling = 0.2;
+  p.raman_energy = 0.4;
+  p.e_ram_coupling = 0.1;
+  p.raman_shift = 1.0;
+  p.ir_phonons = p.raman_phonons = cutoff;
+
+  vector<Triplet<double> > entries;
+  triplet_adder add(entries);
+  hamiltonian_elements(p, add);
+  h.resize(basis_size(p), basis_size(p));
+  h.setFromTriplets(entries.begin(), entries.end());
+  h.prune(0.0);
+}
+
+struct Measure {
+  string kernel;
+  int vectors, threads;
+  double seconds;  // per product by the whole block
+  double gflops, gbytes_per_s;
+};
+
+// One product of h by the k columns of x, either column by column or at once
+void product(const SpMat &h, const MatrixXd &x, MatrixXd &y, bool block) {
+  if (block)
+    y.noalias() = h * x;
+  else
+    for (int c = 0; c < x.cols(); c++)
+      y.col(c).noalias() = h * x.col(c);
+}
+
+// Times "repeat" products after an untimed one, which takes the first-touch page faults
+Measure measure(const SpMat &h, const MatrixXd &x, MatrixXd &y, bool block, int repeat) {
+  product(h, x, y, block);
+  double start = now();
+  for (int r = 0; r < repeat; r++)
+    product(h, x, y, block);
+  Measure m;
+  m.kernel = block ? "spmm" : "spmv";
+  m.vectors = x.cols();
+  m.threads = nbThreads();
+  m.seconds = (now() - start) / repeat;
+
+  double k = x.cols(), traversals = block ? 1 : k;
+  double matrix_bytes = h.nonZeros() * (sizeof(double) + sizeof(int)) + (h.rows() + 1) * sizeof(int);
+  double vector_bytes = (h.rows() + h.cols()) * k * sizeof(double);
+  m.gflops = 2.0 * h.nonZeros() * k / m.seconds * 1e-9;
+  m.gbytes_per_s = (traversals * matrix_bytes + vector_bytes) / m.seconds * 1e-9;
+  return m;
+}
+
+int main (int argc, char *argv[]) {
+  vector<int> grid = parse_list("20,40,80");
+  vector<int> vectors = parse_list("1,8,16,32,64");
+  vector<int> threads(1, 1);
+  const char *output = "spmm-results.json";
+  int repeat = 10;
+
+  for (int n = 2; n <= (int) sysconf(_SC_NPROCESSORS_ONLN); n *= 2)
+    threads.push_back(n);
+
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--grid") == 0 && arg + 1 < argc)
+      grid = parse_list(argv[++arg]);
+    else if (strcmp(argv[arg], "--vectors") == 0 && arg + 1 < argc)
+      vectors = parse_list(argv[++arg]);
+    else if (strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc)
+      threads = parse_list(argv[++arg]);
+    else if (strcmp(argv[arg], "--repeat") == 0 && arg + 1 < argc)
+      repeat = max(1, atoi(argv[++arg]));
+    else if (strcmp(argv[arg], "--output") == 0 && arg + 1 < argc)
+      output = argv[++arg];
+    else {
+      cout << "usage: spmm [--grid list] [--vectors list] [--threads list] [--repeat count] [--output file]\n"
+	   << "       where lists are comma separated values or ranges first:last:step." << endl;
+      return 1;
+    }
+  }
+
+  ofstream report(output);
+  report << "{\n  \"eigen_version\": \"" << EIGEN_WORLD_VERSION << "." << EIGEN_MAJOR_VERSION
+	 << "." << EIGEN_MINOR_VERSION << "\",\n  \"simd\": \"" << SimdInstructionSetsInUse()
+	 << "\",\n  \"results\": [";
+  printf("%6s %8s %10s %6s %4s %8s %12s %9s %9s %8s\n", "cutoff", "size", "nonzeros", "kernel", "k",
+	 "threads", "time [s]", "GFLOP/s", "GB/s", "speedup");
+  for (size_t g = 0; g < grid.size(); g++) {
+    SpMat h;
+    build_hamiltonian(grid[g], h);
+    report << (g ? "," : "") << "\n    {\"n_ir\": " << grid[g] << ", \"n_r\": " << grid[g]
+	   << ", \"size\": " << h.rows() << ", \"nonzeros\": " << h.nonZeros() << ", \"products\": [";
+
+    // Thread counts Eigen cannot use (e.g. built without threads) are measured once
+    vector<int> measured;
+    bool first = true;
+    for (size_t t = 0; t < threads.size(); t++) {
+      setNbThreads(threads[t]);
+      if (find(measured.begin(), measured.end(), nbThreads()) != measured.end())
+	continue;
+      measured.push_back(nbThreads());
+      for (size_t v = 0; v < vectors.size(); v++) {
+	MatrixXd x = MatrixXd::Random(h.cols(), vectors[v]), y(h.rows(), vectors[v]);
+	Measure single = measure(h, x, y, false, repeat);
+	Measure block = measure(h, x, y, true, repeat);
+	Measure both[2] = {single, block};
+	for (int b = 0; b < 2; b++) {
+	  printf("%6d %8d %10d %6s %4d %8d %12.4g %9.3f %9.3f %8.2f\n", grid[g], (int) h.rows(), (int) h.nonZeros(),
+		 both[b].kernel.c_str(), both[b].vectors, both[b].threads, both[b].seconds, both[b].gflops,
+		 both[b].gbytes_per_s, single.seconds / both[b].seconds);
+	  report << (first ? "" : ",") << "\n      {\"kernel\": \"" << both[b].kernel << "\", \"k\": "
+		 << both[b].vectors << ", \"threads\": " << both[b].threads << ", \"wall_s\": " << both[b].seconds
+		 << ", \"gflops\": " << both[b].gflops << ", \"gbytes_per_s\": " << both[b].gbytes_per_s << "}";
+	  first = false;
+	}
+      }
+    }
+    report << "]}";
+  }
+  report << "\n  ]\n}\n";
+  report.close();
+  cout << "Saved the report at \"" << output << "\"." << endl;
+  return 0;
+}
@@ -1,79 +1,320 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
 #include <fstream>
 #include <cmath>
 #include <sstream>
+#include <vector>
 #include <Eigen/Dense>
 #include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "3-sites-linear/model.h"
+#include "3-sites-linear/observables.h"
+#include "profile.h"
 
 using namespace std;
 using namespace Eigen;
 
-typedef SelfAdjointEigenSolver<MatrixXd> MyEigenSolver;
+typedef Tridiagonalization<MatrixXd> MyTridiagonalization;
 IOFormat LongPrinting(20);
 
-void save_eigenvalues(MyEigenSolver);
-void save_eigenvectors(MyEigenSolver);
+void save_eigenvalues(const VectorXd&);
+void save_eigenvectors(const MatrixXd&);
+void save_matrix(string, const MatrixXd&);
+
+
+// State of a dense diagonalization, as saved in the checkpoint file. Like
+// SelfAdjointEigenSolver::compute(), the matrix is divided by "scale", its largest
+// coefficient, before the tridiagonalization. After it "matrix" holds the Householder
+// vectors below its subdiagonal and "hcoeffs" their coefficients; once the QR
+// iterations converged "matrix" holds the eigenvectors and "diag" the eigenvalues,
+// scaled back.
+enum { NOTHING_DONE = 0, TRIDIAGONAL_DONE = 1, EIGENPAIRS_DONE = 2 };
+
+struct DenseState {
+  int stage;
+  double scale;
+  MatrixXd matrix;
+  VectorXd hcoeffs, diag, subdiag;
+};
+
+bool save_checkpoint(string, const char*, const DenseState&);
+bool load_checkpoint(string, const char*, DenseState&);
+
+
+// Receives the eigenvectors in blocks of consecutive columns while they are still in
+// cache, so observables can be reduced on the fly instead of writing "eigenvectors.txt"
+// and reading it back. "first" is the index of the first eigenvector of the block.
+class EigenvectorVisitor {
+public:
+  virtual ~EigenvectorVisitor() {}
+  virtual void visit(int first, const Ref<const MatrixXd> &block) = 0;
+  virtual void finish() {}
+};
+
+// Mean phonons and standard deviations, as written by mean-phonons
+class MeanPhononsVisitor : public EigenvectorVisitor {
+public:
+  MeanPhononsVisitor(const model_parameters &p, int states)
+    : p(p), mean_ir(states), mean_ram(states), stdd_ir(states), stdd_ram(states) {}
+
+  void visit(int first, const Ref<const MatrixXd> &block) {
+    MatrixXd distributions = phonon_distributions(p, block);
+    for (int n = 0; n < block.cols(); n++) {
+      double m_ir = 0, m_ram = 0, sqr_ir = 0, sqr_ram = 0;
+      for (int ram = 0; ram <= p.raman_phonons; ram++) {
+	for (int ir = 0; ir <= p.ir_phonons; ir++) {
+	  double prob = distributions(ir + ram * (p.ir_phonons + 1), n);
+	  m_ir += ir * prob;
+	  m_ram += ram * prob;
+	  sqr_ir += ir * ir * prob;
+	  sqr_ram += ram * ram * prob;
+	}
+      }
+      mean_ir(first + n) = m_ir;
+      mean_ram(first + n) = m_ram;
+      stdd_ir(first + n) = sqrt(sqr_ir - m_ir * m_ir);
+      stdd_ram(first + n) = sqrt(sqr_ram - m_ram * m_ram);
+    }
+  }
+
+  void finish() {
+    cout << "Saving mean phonons and standard deviations at \"mean_ir.txt\", \"mean_ram.txt\", "
+	 << "\"stdd_ir.txt\" and \"stdd_ram.txt\"... ";
+    save_matrix("mean_ir.txt", mean_ir);
+    save_matrix("mean_ram.txt", mean_ram);
+    save_matrix("stdd_ir.txt", stdd_ir);
+    save_matrix("stdd_ram.txt", stdd_ram);
+    cout << "Done." << endl;
+  }
+
+private:
+  model_parameters p;
+  VectorXd mean_ir, mean_ram, stdd_ir, stdd_ram;
+};
+
+// Entanglement spectra and entropies, as written by entanglement
+class EntanglementVisitor : public EigenvectorVisitor {
+public:
+  EntanglementVisitor(int states) : spectrum(9, states), entropy(states) {}
+
+  void visit(int first, const Ref<const MatrixXd> &block) {
+    MatrixXd s;
+    VectorXd e;
+    entanglement_spectra(block, s, e);
+    spectrum.middleCols(first, block.cols()) = s;
+    entropy.segment(first, block.cols()) = e;
+  }
+
+  void finish() {
+    cout << "Saving entanglement spectra and entropies at \"entanglement_spectrum.txt\" and "
+	 << "\"entanglement_entropy.txt\"... ";
+    save_matrix("entanglement_spectrum.txt", spectrum.transpose());
+    save_matrix("entanglement_entropy.txt", entropy);
+    cout << "Done." << endl;
+  }
+
+private:
+  MatrixXd spectrum;
+  VectorXd entropy;
+};
+
+// Hands the eigenvectors to every visitor, "block" columns at a time
+void visit_eigenvectors(const MatrixXd &eigenvectors, int block, vector<EigenvectorVisitor*> &visitors) {
+  for (int first = 0; first < eigenvectors.cols(); first += block) {
+    int cols = min(block, (int) eigenvectors.cols() - first);
+    for (size_t v = 0; v < visitors.size(); v++)
+      visitors[v]->visit(first, eigenvectors.middleCols(first, cols));
+  }
+  for (size_t v = 0; v < visitors.size(); v++)
+    visitors[v]->finish();
+}
+
 
 int main (int argc, char *argv[]) {
-  int size, row, col;
-  double band_energy[3];
+  int size, row, col, arg;
+  int block = 64;
+  bool keep_eigenvectors = true, mean_phonons = false, entanglement = false, bad_usage = false;
+  bool checkpoint = false, resume = false;
+  const char *filename = NULL;
   string line;
 
-  if (argc != 2) {
-    cout << "usage: eig file\n       where 'file' is the matrix you want to diagonalize." << endl;
+  for (arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--mean-phonons") == 0)
+      mean_phonons = true;
+    else if (strcmp(argv[arg], "--entanglement") == 0)
+      entanglement = true;
+    else if (strcmp(argv[arg], "--no-eigenvectors") == 0)
+      keep_eigenvectors = false;
+    else if (strcmp(argv[arg], "--checkpoint") == 0)
+      checkpoint = true;
+    else if (strcmp(argv[arg], "--resume") == 0)
+      checkpoint = resume = true;
+    else if (strcmp(argv[arg], "--profile") == 0)
+      profile::enable("eig");
+    else if (strcmp(argv[arg], "--block") == 0 && arg + 1 < argc)
+      block = max(1, atoi(argv[++arg]));
+    else if (filename == NULL && argv[arg][0] != '-')
+      filename = argv[arg];
+    else
+      bad_usage = true;
+  }
+
+  if (filename == NULL || bad_usage) {
+    cout << "usage: eig [--mean-phonons] [--entanglement] [--no-eigenvectors] [--block n]\n"
+	 << "           [--checkpoint | --resume] [--profile] file\n"
+	 << "       where 'file' is the matrix you want to diagonalize.\n"
+	 << "       --mean-phonons and --entanglement compute those observables from \"parameters.inp\"\n"
+	 << "       while the eigenvectors are in memory, --no-eigenvectors skips \"eigenvectors.txt\"\n"
+	 << "       and --block sets how many eigenvectors are processed at a time (default 64).\n"
+	 << "       --checkpoint saves the progress in 'file.checkpoint' and --resume continues\n"
+	 << "       from it. --profile reports the time and memory spent in each phase." << endl;
     return 1;
-  }   
+  }
 
   // Read the matrix
-  ifstream inFile(argv[1]);
+  ifstream inFile(filename);
   if (inFile) {
     size = count(istreambuf_iterator<char>(inFile),
 		 istreambuf_iterator<char>(), '\n');
     inFile.seekg (0, ios::beg);
-  } 
+  }
   else {
-    cout << "I couldn't open the file: " << argv[1] << endl;
+    cout << "I couldn't open the file: " << filename << endl;
     return 1;
   }
 
-  cout << "There are " << size << " lines so I will assume it's a " << size << "x" << size << " matrix." << endl;
-  
-  MatrixXd m(size,size); 
+  model_parameters p;
+  vector<EigenvectorVisitor*> visitors;
+  if (mean_phonons || entanglement) {
+    if (!read_parameters("parameters.inp", p) || basis_size(p) != size) {
+      cout << "Observables need a \"parameters.inp\" matching the matrix. I can't proceed any further. " << endl;
+      return 1;
+    }
+    if (mean_phonons)
+      visitors.push_back(new MeanPhononsVisitor(p, size));
+    if (entanglement)
+      visitors.push_back(new EntanglementVisitor(size));
+  }
+
+  DenseState state;
+  string checkpoint_file = string(filename) + ".checkpoint";
+  state.stage = NOTHING_DONE;
+  if (resume) {
+    profile::phase timer("checkpoint");
+    if (load_checkpoint(checkpoint_file, filename, state) && state.matrix.rows() == size)
+      cout << "Resuming from \"" << checkpoint_file << "\"." << endl;
+    else
+      state.stage = NOTHING_DONE;
+  }
+
+  if (state.stage < TRIDIAGONAL_DONE) {
+    cout << "There are " << size << " lines so I will assume it's a " << size << "x" << size << " matrix." << endl;
 
-  for (row = 0; row < size; row++) {
-    getline(inFile, line);
-    stringstream ss(line);
-    for (col = 0; col < size; col ++) {
-      float f;
-      ss >> f;
-      m(row, col) = f;
+    MatrixXd &m = state.matrix;
+    profile::phase read_timer("read");
+    m.resize(size, size);
+
+    for (row = 0; row < size; row++) {
+      getline(inFile, line);
+      stringstream ss(line);
+      for (col = 0; col < size; col ++) {
+	float f;
+	ss >> f;
+	m(row, col) = f;
+      }
+    }
+    read_timer.stop();
+
+    cout << "Reducing the matrix to tridiagonal form... ";
+    profile::phase tridiagonalize_timer("tridiagonalize");
+    // scale the matrix to avoid overflows and underflows, as compute() does
+    state.scale = m.cwiseAbs().maxCoeff();
+    if (state.scale == 0)
+      state.scale = 1;
+    m /= state.scale;
+    state.hcoeffs.resize(size - 1);
+    internal::tridiagonalization_inplace(m, state.hcoeffs);
+    state.diag = m.diagonal();
+    state.subdiag = m.diagonal<-1>();
+    state.stage = TRIDIAGONAL_DONE;
+    tridiagonalize_timer.stop();
+    cout << "Done." << endl;
+    if (checkpoint) {
+      profile::phase timer("checkpoint");
+      if (!save_checkpoint(checkpoint_file, filename, state))
+	cout << "Unable to write the checkpoint." << endl;
     }
   }
-  
-  cout << "I will try to calculate the eigenvalues and eigenvectors now." << endl;
-  cout << "This could take some time... ";
-  MyEigenSolver eigensolver(m);
-  cout << "Done." << endl;
+
+  if (state.stage < EIGENPAIRS_DONE) {
+    cout << "I will try to calculate the eigenvalues and eigenvectors now." << endl;
+    cout << "This could take some time... ";
+    MatrixXd &eivec = state.matrix;
+    profile::phase back_transform_timer("back-transform");
+    eivec = MyTridiagonalization::HouseholderSequenceType(eivec, state.hcoeffs)
+      .setLength(size - 1)
+      .setShift(1);
+    back_transform_timer.stop();
+    profile::phase qr_timer("QR");
+    if (internal::computeFromTridiagonal_impl(state.diag, state.subdiag, 30, true, eivec) != Success) {
+      cout << "The QR iterations did not converge." << endl;
+      return 1;
+    }
+    qr_timer.stop();
+    state.diag *= state.scale;
+    state.scale = 1;
+    state.hcoeffs.resize(0);
+    state.subdiag.resize(0);
+    state.stage = EIGENPAIRS_DONE;
+    cout << "Done." << endl;
+    if (checkpoint) {
+      profile::phase timer("checkpoint");
+      if (!save_checkpoint(checkpoint_file, filename, state))
+	cout << "Unable to write the checkpoint." << endl;
+    }
+  }
+
+  const VectorXd &eigenvalues = state.diag;
+  const MatrixXd &eigenvectors = state.matrix;
 
   cout << "Saving the eigenvalues at \"eigenvalues.txt\"... ";
-  save_eigenvalues(eigensolver);
+  profile::phase write_timer("write");
+  save_eigenvalues(eigenvalues);
+  write_timer.stop();
   cout << "Done." << endl;
 
-  cout << "Saving the eigenvectors at \"eigenvectors.txt\"... ";
-  save_eigenvectors(eigensolver);
-  cout << "Done." << endl;
+  if (!visitors.empty()) {
+    cout << "Calculating observables " << block << " eigenvectors at a time." << endl;
+    profile::phase timer("observables");
+    visit_eigenvectors(eigenvectors, block, visitors);
+    for (size_t v = 0; v < visitors.size(); v++)
+      delete visitors[v];
+  }
+
+  if (keep_eigenvectors) {
+    cout << "Saving the eigenvectors at \"eigenvectors.txt\"... ";
+    profile::phase timer("write");
+    save_eigenvectors(eigenvectors);
+    cout << "Done." << endl;
+  }
 
+  if (checkpoint)
+    unlink(checkpoint_file.c_str());
+
+  profile::report();
   return 0;
 }
 
 
-void save_eigenvalues(MyEigenSolver eigensolver) {
+void save_eigenvalues(const VectorXd &eigenvalues) {
     ofstream eigvfile;
     eigvfile.open("eigenvalues.txt", ios::out);
     if (eigvfile.is_open()) {
-      eigvfile << eigensolver.eigenvalues().format(LongPrinting);
+      eigvfile << eigenvalues.format(LongPrinting);
       eigvfile << endl;
       eigvfile.close();
     }
@@ -84,11 +325,11 @@ void save_eigenvalues(MyEigenSolver eigensolver) {
 }
 
 
-void save_eigenvectors(MyEigenSolver eigensolver) {
+void save_eigenvectors(const MatrixXd &eigenvectors) {
     ofstream eigvfile;
     eigvfile.open("eigenvectors.txt", ios::out);
     if (eigvfile.is_open()) {
-      eigvfile << eigensolver.eigenvectors().format(LongPrinting);
+      eigvfile << eigenvectors.format(LongPrinting);
       eigvfile << endl;
       eigvfile.close();
     }
@@ -97,3 +338,118 @@ void save_eigenvectors(MyEigenSolver eigensolver) {
     }
     return;
 }
+
+
+void save_matrix(string filename, const MatrixXd &m) {
+    ofstream outfile;
+    outfile.open(filename.c_str(), ios::out);
+    if (outfile.is_open()) {
+      outfile << m.format(LongPrinting);
+      outfile << endl;
+      outfile.close();
+    }
+    else {
+      cout << "Unable to create file" << endl;
+    }
+    return;
+}
+
+
+// The checkpoint starts with a header identifying the stage and the input file (its
+// size and modification time), followed by the raw contents of the DenseState. It is
+// written to a temporary file which is then renamed, so an interrupted write never
+// replaces a good checkpoint.
+struct CheckpointHeader {
+  char magic[8];
+  int64_t stage, size, input_bytes, input_mtime;
+  double scale;
+};
+
+bool checkpoint_header(const char *input, int stage, int size, double scale, CheckpointHeader &header) {
+  struct stat st;
+  if (stat(input, &st) != 0)
+    return false;
+  memcpy(header.magic, "EIGCKPT2", 8);
+  header.stage = stage;
+  header.size = size;
+  header.input_bytes = st.st_size;
+  header.input_mtime = st.st_mtime;
+  header.scale = scale;
+  return true;
+}
+
+bool write_all(int fd, const void *data, size_t bytes) {
+  const char *p = (const char *) data;
+  while (bytes > 0) {
+    ssize_t n = write(fd, p, bytes);
+    if (n <= 0)
+      return false;
+    p += n;
+    bytes -= n;
+  }
+  return true;
+}
+
+bool read_all(int fd, void *data, size_t bytes) {
+  char *p = (char *) data;
+  while (bytes > 0) {
+    ssize_t n = read(fd, p, bytes);
+    if (n <= 0)
+      return false;
+    p += n;
+    bytes -= n;
+  }
+  return true;
+}
+
+bool save_checkpoint(string filename, const char *input, const DenseState &state) {
+  CheckpointHeader header;
+  if (!checkpoint_header(input, state.stage, state.matrix.rows(), state.scale, header))
+    return false;
+
+  string tmp = filename + ".tmp";
+  int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+  bool ok = write_all(fd, &header, sizeof(header))
+    && write_all(fd, state.matrix.data(), state.matrix.size() * sizeof(double))
+    && write_all(fd, state.diag.data(), state.diag.size() * sizeof(double));
+  if (state.stage == TRIDIAGONAL_DONE)
+    ok = ok && write_all(fd, state.hcoeffs.data(), state.hcoeffs.size() * sizeof(double))
+      && write_all(fd, state.subdiag.data(), state.subdiag.size() * sizeof(double));
+  ok = ok && fsync(fd) == 0;
+  ok = close(fd) == 0 && ok;
+  if (ok)
+    ok = rename(tmp.c_str(), filename.c_str()) == 0;
+  else
+    unlink(tmp.c_str());
+  return ok;
+}
+
+bool load_checkpoint(string filename, const char *input, DenseState &state) {
+  CheckpointHeader header, expected;
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  bool ok = read_all(fd, &header, sizeof(header))
+    && checkpoint_header(input, header.stage, header.size, header.scale, expected)
+    && memcmp(&header, &expected, sizeof(header)) == 0
+    && (header.stage == TRIDIAGONAL_DONE || header.stage == EIGENPAIRS_DONE);
+  if (ok) {
+    int size = header.size;
+    state.stage = header.stage;
+    state.scale = header.scale;
+    state.matrix.resize(size, size);
+    state.diag.resize(size);
+    ok = read_all(fd, state.matrix.data(), state.matrix.size() * sizeof(double))
+      && read_all(fd, state.diag.data(), state.diag.size() * sizeof(double));
+    if (state.stage == TRIDIAGONAL_DONE) {
+      state.hcoeffs.resize(size - 1);
+      state.subdiag.resize(size - 1);
+      ok = ok && read_all(fd, state.hcoeffs.data(), state.hcoeffs.size() * sizeof(double))
+	&& read_all(fd, state.subdiag.data(), state.subdiag.size() * sizeof(double));
+    }
+  }
+  close(fd);
+  return ok;
+}
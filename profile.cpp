@@ -0,0 +1,37 @@
+/*
+  The global operator new and delete counting the allocations reported by profile.h.
+  Every tool including profile.h is linked with this file.
+ */
+
+#include "profile.h"
+
+void *operator new(size_t size) {
+  profile::counters &c = profile::allocation_counters();
+  __sync_fetch_and_add(&c.allocations, 1);
+  __sync_fetch_and_add(&c.bytes, (long long) size);
+  void *p = malloc(size ? size : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *p) throw() {
+  free(p);
+}
+
+void operator delete[](void *p) throw() {
+  free(p);
+}
+
+// The sized forms, used instead of the ones above when the size is known
+void operator delete(void *p, size_t) throw() {
+  free(p);
+}
+
+void operator delete[](void *p, size_t) throw() {
+  free(p);
+}
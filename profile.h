@@ -0,0 +1,182 @@
+/*
+  Phase-level profiling for the command line tools.
+
+  A tool calls profile::enable() when it gets --profile and wraps each phase of its
+  work in a profile::phase, a scoped timer which is stopped by its destructor or by
+  stop(). For every phase name the profiler accumulates the wall time, the number of
+  calls, the heap allocations made through operator new (count and bytes) and the peak
+  RSS of the process when the phase ended. profile::report() prints a table and writes
+  the same data as JSON to "<tool>.profile.json".
+
+  The allocation counters come from the global operator new and delete replaced in
+  profile.cpp, which every program including this header has to be linked with.
+
+  Eigen allocates its matrices with malloc, not operator new. When the tools are built
+  with Eigen's allocation statistics, e.g.
+
+    make CPPFLAGS="-I ./ -DEIGEN_ALLOCATION_STATS"
+
+  every phase also reports the number of Eigen allocations, the bytes they requested and
+  the peak of the bytes Eigen had allocated during the phase. Phases must not be nested
+  for the Eigen peak to be meaningful.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include <sys/resource.h>
+#ifdef EIGEN_ALLOCATION_STATS
+#include <Eigen/Core>
+#endif
+
+namespace profile {
+
+struct counters {
+  long allocations;
+  long long bytes;
+};
+
+inline counters &allocation_counters() {
+  static counters c = {0, 0};
+  return c;
+}
+
+struct phase_record {
+  std::string name;
+  int calls;
+  double seconds;
+  long allocations;
+  long long bytes;
+  long peak_rss_kb;
+  long eigen_allocations;
+  long long eigen_bytes;
+  long long eigen_peak_bytes;
+};
+
+struct profiler {
+  bool enabled;
+  std::string tool;
+  std::vector<phase_record> phases;
+};
+
+inline profiler &instance() {
+  static profiler p = {false, "", std::vector<phase_record>()};
+  return p;
+}
+
+inline double now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+inline long peak_rss_kb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+inline void enable(const char *tool) {
+  instance().enabled = true;
+  instance().tool = tool;
+}
+
+// Scoped timer for one phase
+class phase {
+public:
+  phase(const char *name) : name(name), running(instance().enabled) {
+    if (running) {
+#ifdef EIGEN_ALLOCATION_STATS
+      Eigen::resetAllocationStats();
+#endif
+      start_allocations = allocation_counters();
+      start = now();
+    }
+  }
+
+  ~phase() { stop(); }
+
+  void stop() {
+    if (!running)
+      return;
+    running = false;
+    double seconds = now() - start;
+    counters end = allocation_counters();
+    std::vector<phase_record> &phases = instance().phases;
+    size_t p = 0;
+    while (p < phases.size() && phases[p].name != name)
+      p++;
+    if (p == phases.size()) {
+      phase_record record = {name, 0, 0, 0, 0, 0, 0, 0, 0};
+      phases.push_back(record);
+    }
+    phases[p].calls++;
+    phases[p].seconds += seconds;
+    phases[p].allocations += end.allocations - start_allocations.allocations;
+    phases[p].bytes += end.bytes - start_allocations.bytes;
+    phases[p].peak_rss_kb = peak_rss_kb();
+#ifdef EIGEN_ALLOCATION_STATS
+    Eigen::AllocationStats eigen = Eigen::allocationStats();
+    phases[p].eigen_allocations += eigen.allocations;
+    phases[p].eigen_bytes += eigen.totalBytes;
+    if ((long long) eigen.peakBytes > phases[p].eigen_peak_bytes)
+      phases[p].eigen_peak_bytes = eigen.peakBytes;
+#endif
+  }
+
+private:
+  std::string name;
+  bool running;
+  double start;
+  counters start_allocations;
+};
+
+inline void report() {
+  profiler &p = instance();
+  if (!p.enabled)
+    return;
+
+  printf("\nProfile of %s:\n", p.tool.c_str());
+  printf("  %-16s %6s %12s %12s %14s %14s\n", "phase", "calls", "time [s]", "allocations", "bytes", "peak RSS [kB]");
+  for (size_t i = 0; i < p.phases.size(); i++)
+    printf("  %-16s %6d %12.4f %12ld %14lld %14ld\n", p.phases[i].name.c_str(), p.phases[i].calls,
+	   p.phases[i].seconds, p.phases[i].allocations, p.phases[i].bytes, p.phases[i].peak_rss_kb);
+#ifdef EIGEN_ALLOCATION_STATS
+  printf("\nEigen allocations:\n");
+  printf("  %-16s %12s %14s %14s\n", "phase", "allocations", "bytes", "peak bytes");
+  for (size_t i = 0; i < p.phases.size(); i++)
+    printf("  %-16s %12ld %14lld %14lld\n", p.phases[i].name.c_str(), p.phases[i].eigen_allocations,
+	   p.phases[i].eigen_bytes, p.phases[i].eigen_peak_bytes);
+#endif
+
+  std::string filename = p.tool + ".profile.json";
+  FILE *json = fopen(filename.c_str(), "w");
+  if (json == NULL) {
+    printf("Unable to create file \"%s\"\n", filename.c_str());
+    return;
+  }
+  fprintf(json, "{\n  \"tool\": \"%s\",\n  \"peak_rss_kb\": %ld,\n  \"phases\": [", p.tool.c_str(), peak_rss_kb());
+  for (size_t i = 0; i < p.phases.size(); i++) {
+    fprintf(json, "%s\n    {\"phase\": \"%s\", \"calls\": %d, \"wall_s\": %.6f, \"allocations\": %ld, "
+	    "\"bytes\": %lld, \"peak_rss_kb\": %ld", i ? "," : "", p.phases[i].name.c_str(), p.phases[i].calls,
+	    p.phases[i].seconds, p.phases[i].allocations, p.phases[i].bytes, p.phases[i].peak_rss_kb);
+#ifdef EIGEN_ALLOCATION_STATS
+    fprintf(json, ", \"eigen_allocations\": %ld, \"eigen_bytes\": %lld, \"eigen_peak_bytes\": %lld",
+	    p.phases[i].eigen_allocations, p.phases[i].eigen_bytes, p.phases[i].eigen_peak_bytes);
+#endif
+    fprintf(json, "}");
+  }
+  fprintf(json, "\n  ]\n}\n");
+  fclose(json);
+  printf("Saved the profile at \"%s\"\n", filename.c_str());
+}
+
+} // namespace profile
+
+#endif // PROFILE_H
@@ -0,0 +1,293 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_BLOCK_SPARSE_MATRIX_H
+#define EIGEN_BLOCK_SPARSE_MATRIX_H
+
+namespace Eigen {
+
+template<typename _BlockType, typename _Index> class BlockSparseMatrix;
+template<typename Lhs, typename Rhs> class BlockSparseProduct;
+
+namespace internal {
+
+/** \internal Describes how the blocks of a BlockSparseMatrix are stored and multiplied.
+  * Only square fixed size blocks are supported: dense ones, and diagonal ones. */
+template<typename BlockType> struct bsr_block_traits;
+
+template<typename _Scalar, int _Size, int _Options>
+struct bsr_block_traits<Matrix<_Scalar,_Size,_Size,_Options,_Size,_Size> >
+{
+  typedef _Scalar Scalar;
+  enum {
+    Size = _Size,
+    StoredSize = _Size*_Size
+  };
+  typedef Map<const Matrix<Scalar,Size,Size> > ConstMapType;
+
+  static inline bool admits(DenseIndex, DenseIndex) { return true; }
+  static inline DenseIndex offset(DenseIndex i, DenseIndex j) { return i + j*Size; }
+
+  template<typename Rhs, typename Dest>
+  static EIGEN_STRONG_INLINE void addProduct(const Scalar* block, const Rhs& rhs, Dest& dst)
+  {
+    dst.noalias() += ConstMapType(block).lazyProduct(rhs);
+  }
+};
+
+template<typename _Scalar, int _Size>
+struct bsr_block_traits<DiagonalMatrix<_Scalar,_Size,_Size> >
+{
+  typedef _Scalar Scalar;
+  enum {
+    Size = _Size,
+    StoredSize = _Size
+  };
+  typedef Map<const Matrix<Scalar,Size,1> > ConstMapType;
+
+  static inline bool admits(DenseIndex i, DenseIndex j) { return i==j; }
+  static inline DenseIndex offset(DenseIndex i, DenseIndex) { return i; }
+
+  template<typename Rhs, typename Dest>
+  static EIGEN_STRONG_INLINE void addProduct(const Scalar* block, const Rhs& rhs, Dest& dst)
+  {
+    dst += ConstMapType(block).asDiagonal() * rhs;
+  }
+};
+
+} // end namespace internal
+
+/** \ingroup SparseExtra_Module
+  * \class BlockSparseMatrix
+  *
+  * \brief A read-only sparse matrix made of square fixed size blocks, in the block compressed row (BSR) format
+  *
+  * \param _BlockType the type of the blocks, either Matrix<Scalar,N,N> or DiagonalMatrix<Scalar,N>
+  * \param _Index the type of the block indices
+  *
+  * The matrix is split into N x N blocks, and only the blocks holding at least one nonzero are stored, block
+  * row after block row, with one index per block instead of one per coefficient. Each block of a product is
+  * a fixed size dense product with N consecutive coefficients of the rhs, which the compiler fully unrolls
+  * and vectorizes. DiagonalMatrix blocks store their diagonal only; they suit the couplings which do not
+  * touch the inner degrees of freedom, e.g., the phonon ladders of an electron-phonon hamiltonian whose
+  * N electronic states are numbered consecutively. An operator mixing both kinds is best split into a sum
+  * of two such matrices accumulated with addProductTo().
+  *
+  * \code
+  * BlockSparseMatrix<Matrix<double,9,9> > H(A);     // A is any sparse matrix with 9 x 9 blocks
+  * y = H * x;                                       // x may have several columns
+  * H.addProductTo(x, y, alpha);                     // y += alpha * A * x, in place
+  * \endcode
+  *
+  * The products are split among the threads by ranges of block rows, as the sparse * dense products of
+  * SparseMatrix, see EIGEN_PARALLEL_SPMV_THRESHOLD.
+  *
+  * \sa SparseMatrix, SlicedEllpackMatrix
+  */
+template<typename _BlockType, typename _Index = int>
+class BlockSparseMatrix
+{
+    typedef internal::bsr_block_traits<_BlockType> BlockTraits;
+  public:
+    typedef _BlockType BlockType;
+    typedef typename BlockTraits::Scalar Scalar;
+    typedef _Index Index;
+    enum {
+      /** the number of rows and columns of a block */
+      BlockSize = BlockTraits::Size,
+      /** the number of coefficients stored per block */
+      BlockStoredSize = BlockTraits::StoredSize
+    };
+
+    /** Default constructor yielding an empty 0 x 0 matrix */
+    BlockSparseMatrix() : m_blockRows(0), m_blockCols(0) {}
+
+    /** Constructs the block representation of the sparse matrix \a mat.
+      * \sa compute() */
+    template<typename OtherDerived>
+    explicit BlockSparseMatrix(const SparseMatrixBase<OtherDerived>& mat)
+    {
+      compute(mat);
+    }
+
+    /** Builds the block representation of the sparse matrix \a mat. Its sizes must be multiples of BlockSize,
+      * and with diagonal blocks its nonzeros must lie on the diagonals of the blocks.
+      */
+    template<typename OtherDerived>
+    BlockSparseMatrix& compute(const SparseMatrixBase<OtherDerived>& mat)
+    {
+      // the rows of a block row are needed together
+      typedef typename internal::conditional<bool(OtherDerived::Flags&RowMajorBit),
+                                             const OtherDerived&,
+                                             SparseMatrix<Scalar,RowMajor,Index> >::type RowMajorNested;
+      RowMajorNested rowMajor(mat.derived());
+      typedef typename internal::remove_all<RowMajorNested>::type RowMajorType;
+
+      eigen_assert(mat.rows()%BlockSize==0 && mat.cols()%BlockSize==0
+                   && "the sizes of the matrix must be multiples of the block size");
+      m_blockRows = Index(mat.rows()) / BlockSize;
+      m_blockCols = Index(mat.cols()) / BlockSize;
+
+      // first pass: the block columns of each block row, marked in place by the block row which last met them
+      Matrix<Index,Dynamic,1> mark = Matrix<Index,Dynamic,1>::Constant(m_blockCols, -1);
+      std::vector<Index> blockCols;
+      m_blockPtr.resize(m_blockRows+1);
+      m_blockPtr(0) = 0;
+      for(Index bi=0; bi<m_blockRows; ++bi)
+      {
+        const std::size_t begin = blockCols.size();
+        for(Index i=bi*BlockSize; i<(bi+1)*BlockSize; ++i)
+          for(typename RowMajorType::InnerIterator it(rowMajor,i); it; ++it)
+          {
+            const Index bj = Index(it.index()) / BlockSize;
+            if(mark(bj)!=bi)
+            {
+              mark(bj) = bi;
+              blockCols.push_back(bj);
+            }
+          }
+        std::sort(blockCols.begin()+begin, blockCols.end());
+        m_blockPtr(bi+1) = Index(blockCols.size());
+      }
+      m_blockIndices = Map<const Matrix<Index,Dynamic,1> >(blockCols.empty() ? 0 : &blockCols[0], Index(blockCols.size()));
+
+      // second pass: the coefficients, the position of each block being recorded in mark
+      m_values.setZero(Index(blockCols.size()) * BlockStoredSize);
+      for(Index bi=0; bi<m_blockRows; ++bi)
+      {
+        for(Index k=m_blockPtr(bi); k<m_blockPtr(bi+1); ++k)
+          mark(m_blockIndices(k)) = k;
+        for(Index i=bi*BlockSize; i<(bi+1)*BlockSize; ++i)
+          for(typename RowMajorType::InnerIterator it(rowMajor,i); it; ++it)
+          {
+            const Index j = Index(it.index());
+            eigen_assert(BlockTraits::admits(i%BlockSize, j%BlockSize)
+                         && "the nonzeros of the matrix do not fit the structure of the blocks");
+            m_values(mark(j/BlockSize)*BlockStoredSize + BlockTraits::offset(i%BlockSize, j%BlockSize)) += it.value();
+          }
+      }
+      return *this;
+    }
+
+    inline Index rows() const { return m_blockRows * BlockSize; }
+    inline Index cols() const { return m_blockCols * BlockSize; }
+    /** \returns the number of rows of blocks */
+    inline Index blockRows() const { return m_blockRows; }
+    /** \returns the number of columns of blocks */
+    inline Index blockCols() const { return m_blockCols; }
+    /** \returns the number of stored blocks */
+    inline Index nonZeroBlocks() const { return Index(m_blockIndices.size()); }
+    /** \returns the number of stored coefficients, that is nonZeroBlocks() * BlockStoredSize */
+    inline Index storedSize() const { return Index(m_values.size()); }
+
+    /** \returns an expression of the product of *this by the dense matrix \a other */
+    template<typename OtherDerived>
+    inline const BlockSparseProduct<BlockSparseMatrix,OtherDerived> operator*(const MatrixBase<OtherDerived>& other) const
+    {
+      return BlockSparseProduct<BlockSparseMatrix,OtherDerived>(*this, other.derived());
+    }
+
+    /** Adds \a alpha * (*this) * \a rhs to \a dst. */
+    template<typename Rhs, typename Dest>
+    void addProductTo(const MatrixBase<Rhs>& rhs, const MatrixBase<Dest>& dst, const Scalar& alpha = Scalar(1)) const
+    {
+      eigen_assert(rhs.rows()==cols() && dst.rows()==rows() && dst.cols()==rhs.cols());
+      typedef typename internal::conditional<bool(int(internal::traits<Rhs>::Flags)&DirectAccessBit),
+                                             const Rhs&, typename Rhs::PlainObject>::type RhsNested;
+      RhsNested actualRhs(rhs.derived());
+      typedef typename internal::remove_all<RhsNested>::type ActualRhsType;
+
+      product_range<ActualRhsType,Dest> func;
+      func.mat = this;
+      func.rhs = &actualRhs;
+      func.dst = &dst.const_cast_derived();
+      func.alpha = alpha;
+
+      const Index grain = (std::max)(Index(1), Index(double(EIGEN_PARALLEL_SPMV_THRESHOLD) * double(m_blockRows)
+                                                     / (double(storedSize() + 1) * double(rhs.cols()))));
+      internal::parallel_for(m_blockRows, grain, func);
+    }
+
+  protected:
+
+    // Computes the block rows [first,last) of the product
+    template<typename Rhs, typename Dest> struct product_range
+    {
+      void operator()(Index first, Index last) const
+      {
+        Matrix<Scalar,BlockSize,Rhs::ColsAtCompileTime,ColMajor,BlockSize,Rhs::MaxColsAtCompileTime> acc(Index(BlockSize), Index(rhs->cols()));
+        for(Index bi=first; bi<last; ++bi)
+        {
+          acc.setZero();
+          for(Index k=mat->m_blockPtr(bi); k<mat->m_blockPtr(bi+1); ++k)
+            BlockTraits::addProduct(mat->m_values.data() + k*BlockStoredSize,
+                                    rhs->template middleRows<BlockSize>(mat->m_blockIndices(k)*BlockSize), acc);
+          dst->template middleRows<BlockSize>(bi*BlockSize) += alpha * acc;
+        }
+      }
+
+      const BlockSparseMatrix* mat;
+      const Rhs* rhs;
+      Dest* dst;
+      Scalar alpha;
+    };
+
+    Index m_blockRows, m_blockCols;
+    Matrix<Index,Dynamic,1> m_blockPtr;       // start of each block row in m_blockIndices
+    Matrix<Index,Dynamic,1> m_blockIndices;   // the block column of each stored block
+    Matrix<Scalar,Dynamic,1> m_values;        // the blocks one after the other, as stored by their BlockTraits
+};
+
+namespace internal {
+template<typename Lhs, typename Rhs>
+struct traits<BlockSparseProduct<Lhs,Rhs> >
+{
+  typedef Matrix<typename Lhs::Scalar,Dynamic,Rhs::ColsAtCompileTime> ReturnType;
+};
+}
+
+/** \ingroup SparseExtra_Module
+  *
+  * \brief Expression of the product of a BlockSparseMatrix by a dense matrix
+  *
+  * \sa BlockSparseMatrix::operator*()
+  */
+template<typename Lhs, typename Rhs>
+class BlockSparseProduct : public ReturnByValue<BlockSparseProduct<Lhs,Rhs> >
+{
+  public:
+    typedef typename Lhs::Scalar Scalar;
+    typedef typename Rhs::Index Index;
+
+    BlockSparseProduct(const Lhs& lhs, const Rhs& rhs) : m_lhs(lhs), m_rhs(rhs) {}
+
+    inline Index rows() const { return m_lhs.rows(); }
+    inline Index cols() const { return m_rhs.cols(); }
+
+    template<typename Dest> void evalTo(Dest& dst) const
+    {
+      // dst is cleared before the rhs is read, so x = A * x goes through a temporary
+      if(internal::dense_storage_may_alias(m_rhs, dst))
+      {
+        typename internal::traits<BlockSparseProduct>::ReturnType tmp(rows(), cols());
+        tmp.setZero();
+        m_lhs.addProductTo(m_rhs, tmp);
+        dst = tmp;
+        return;
+      }
+      dst.setZero();
+      m_lhs.addProductTo(m_rhs, dst);
+    }
+
+  protected:
+    const Lhs& m_lhs;
+    typename Rhs::Nested m_rhs;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_BLOCK_SPARSE_MATRIX_H
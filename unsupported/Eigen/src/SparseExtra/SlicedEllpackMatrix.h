@@ -0,0 +1,345 @@
+// This file is part of Eigen, a lightweight C++ template library
+// for linear algebra.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGEN_SLICED_ELLPACK_MATRIX_H
+#define EIGEN_SLICED_ELLPACK_MATRIX_H
+
+namespace Eigen {
+
+template<typename _Scalar, typename _Index> class SlicedEllpackMatrix;
+template<typename Lhs, typename Rhs> class SlicedEllpackProduct;
+
+/** \ingroup SparseExtra_Module
+  * \class SlicedEllpackMatrix
+  *
+  * \brief A read-only sparse matrix in the SELL-C-sigma format, for fast matrix * vector products
+  *
+  * \param _Scalar the scalar type, i.e. the type of the coefficients
+  * \param _Index the type of the column indices
+  *
+  * The rows are grouped by chunks of C consecutive rows, C being the packet size of \c _Scalar. Each chunk
+  * is stored column-wise as a dense C x w block, w being the length of its longest row, the shorter rows
+  * being padded with zeros. A product then processes the C rows of a chunk at once: one packet load of the
+  * values, one gather of the rhs coefficients and one multiply-add per column of the chunk, whatever the
+  * length of the rows. To limit the padding, the rows are sorted by decreasing length within windows of
+  * sigma rows before being chunked; the products scatter their results back to the original rows.
+  *
+  * This format pays off when the rows are short and of similar lengths, which leaves the vectorization of
+  * a compressed row-major SparseMatrix with little to work on. The ratio nonZeros()/storedSize() measures
+  * the overhead of the padding.
+  *
+  * \code
+  * SlicedEllpackMatrix<double> sell(A);   // A is any sparse matrix
+  * y = sell * x;                           // x may have several columns
+  * sell.addProductTo(x, y, alpha);         // y += alpha * A * x, in place
+  * \endcode
+  *
+  * The products are split among the threads by ranges of chunks, as the sparse * dense products of
+  * SparseMatrix, see EIGEN_PARALLEL_SPMV_THRESHOLD.
+  *
+  * \sa SparseMatrix
+  */
+template<typename _Scalar, typename _Index = int>
+class SlicedEllpackMatrix
+{
+  public:
+    typedef _Scalar Scalar;
+    typedef _Index Index;
+    typedef typename internal::packet_traits<Scalar>::type Packet;
+    enum {
+      /** the number of rows of a chunk, i.e., the packet size */
+      ChunkSize = internal::packet_traits<Scalar>::size
+    };
+
+    /** Default constructor yielding an empty 0 x 0 matrix */
+    SlicedEllpackMatrix() : m_rows(0), m_cols(0), m_sigma(ChunkSize), m_nonZeros(0) {}
+
+    /** Constructs the SELL-C-sigma representation of the sparse matrix \a mat.
+      * \sa compute() */
+    template<typename OtherDerived>
+    explicit SlicedEllpackMatrix(const SparseMatrixBase<OtherDerived>& mat, Index sigma = 256)
+    {
+      compute(mat, sigma);
+    }
+
+    /** Builds the SELL-C-sigma representation of the sparse matrix \a mat, the rows being sorted by
+      * decreasing length within windows of \a sigma rows. \a sigma is rounded up to a multiple of ChunkSize;
+      * ChunkSize keeps the order of the rows, and a value larger than rows() sorts them all.
+      */
+    template<typename OtherDerived>
+    SlicedEllpackMatrix& compute(const SparseMatrixBase<OtherDerived>& mat, Index sigma = 256)
+    {
+      // the rows are needed one after the other
+      typedef typename internal::conditional<bool(OtherDerived::Flags&RowMajorBit),
+                                             const OtherDerived&,
+                                             SparseMatrix<Scalar,RowMajor,Index> >::type RowMajorNested;
+      RowMajorNested rowMajor(mat.derived());
+      typedef typename internal::remove_all<RowMajorNested>::type RowMajorType;
+
+      m_rows = Index(mat.rows());
+      m_cols = Index(mat.cols());
+      m_sigma = (std::max)(Index(1), (sigma + ChunkSize - 1) / ChunkSize) * ChunkSize;
+
+      const Index chunks = (m_rows + ChunkSize - 1) / ChunkSize;
+      Matrix<Index,Dynamic,1> lengths(m_rows);
+      for(Index i=0; i<m_rows; ++i)
+      {
+        Index n = 0;
+        for(typename RowMajorType::InnerIterator it(rowMajor,i); it; ++it)
+          ++n;
+        lengths(i) = n;
+      }
+      m_nonZeros = lengths.sum();
+
+      // sort the rows by decreasing length within the sigma windows
+      m_perm.resize(chunks*ChunkSize);
+      for(Index i=0; i<m_rows; ++i)
+        m_perm(i) = i;
+      for(Index i=m_rows; i<chunks*ChunkSize; ++i)
+        m_perm(i) = -1;
+      for(Index w=0; w<m_rows; w+=m_sigma)
+        std::stable_sort(m_perm.data()+w, m_perm.data()+(std::min)(w+m_sigma,m_rows), longer_row(lengths.data()));
+
+      // the chunks are as wide as their longest row
+      m_chunkPtr.resize(chunks+1);
+      m_chunkPtr(0) = 0;
+      for(Index k=0; k<chunks; ++k)
+      {
+        Index width = 0;
+        for(Index l=0; l<ChunkSize; ++l)
+          if(m_perm(k*ChunkSize+l)>=0)
+            width = (std::max)(width, lengths(m_perm(k*ChunkSize+l)));
+        m_chunkPtr(k+1) = m_chunkPtr(k) + width*ChunkSize;
+      }
+
+      // the padding gets a zero value and the column index of the last entry of its row, or 0,
+      // so that the gathers stay in bounds
+      m_values.setZero(m_chunkPtr(chunks));
+      m_indices.setZero(m_chunkPtr(chunks));
+      for(Index k=0; k<chunks; ++k)
+      {
+        const Index width = (m_chunkPtr(k+1) - m_chunkPtr(k)) / ChunkSize;
+        for(Index l=0; l<ChunkSize; ++l)
+        {
+          const Index row = m_perm(k*ChunkSize+l);
+          if(row<0)
+            continue;
+          Index j = 0, last = 0;
+          for(typename RowMajorType::InnerIterator it(rowMajor,row); it; ++it, ++j)
+          {
+            m_values(m_chunkPtr(k) + j*ChunkSize + l) = it.value();
+            m_indices(m_chunkPtr(k) + j*ChunkSize + l) = last = Index(it.index());
+          }
+          for(; j<width; ++j)
+            m_indices(m_chunkPtr(k) + j*ChunkSize + l) = last;
+        }
+      }
+      return *this;
+    }
+
+    inline Index rows() const { return m_rows; }
+    inline Index cols() const { return m_cols; }
+    /** \returns the width of the windows within which the rows are sorted */
+    inline Index sigma() const { return m_sigma; }
+    /** \returns the number of nonzero coefficients */
+    inline Index nonZeros() const { return m_nonZeros; }
+    /** \returns the number of stored coefficients, that is the nonzeros and the padding */
+    inline Index storedSize() const { return Index(m_values.size()); }
+
+    /** \returns the original row stored at the position \a i, or -1 for the padding rows of the last chunk */
+    inline Index storedRow(Index i) const { return m_perm(i); }
+
+    /** \returns an expression of the product of *this by the dense matrix \a other */
+    template<typename OtherDerived>
+    inline const SlicedEllpackProduct<SlicedEllpackMatrix,OtherDerived> operator*(const MatrixBase<OtherDerived>& other) const
+    {
+      return SlicedEllpackProduct<SlicedEllpackMatrix,OtherDerived>(*this, other.derived());
+    }
+
+    /** Adds \a alpha * (*this) * \a rhs to \a dst. */
+    template<typename Rhs, typename Dest>
+    void addProductTo(const MatrixBase<Rhs>& rhs, const MatrixBase<Dest>& dst, const Scalar& alpha = Scalar(1)) const
+    {
+      eigen_assert(rhs.rows()==m_cols && dst.rows()==m_rows && dst.cols()==rhs.cols());
+      // the columns of the rhs are gathered from, hence have to be sequentially stored in memory
+      enum {
+        UseRhs = (int(internal::traits<Rhs>::Flags)&DirectAccessBit) && !(int(internal::traits<Rhs>::Flags)&RowMajorBit)
+              && int(Rhs::InnerStrideAtCompileTime)==1
+      };
+      typedef typename internal::conditional<UseRhs, const Rhs&, Matrix<Scalar,Dynamic,Dynamic> >::type RhsNested;
+      RhsNested actualRhs(rhs.derived());
+
+      product_range<Dest> func;
+      func.mat = this;
+      func.rhs = actualRhs.data();
+      func.rhsStride = Index(actualRhs.outerStride());
+      func.rhsCols = Index(actualRhs.cols());
+      func.dst = &dst.const_cast_derived();
+      func.alpha = alpha;
+
+      const Index chunks = Index(m_chunkPtr.size()) - 1;
+      const Index grain = chunks==0 ? 1
+                        : (std::max)(Index(1), Index(double(EIGEN_PARALLEL_SPMV_THRESHOLD) * double(chunks)
+                                                     / (double(storedSize() + 1) * double(func.rhsCols))));
+      internal::parallel_for(chunks, grain, func);
+    }
+
+  protected:
+
+    struct longer_row
+    {
+      longer_row(const Index* lengths) : m_lengths(lengths) {}
+      bool operator()(Index a, Index b) const { return m_lengths[a] > m_lengths[b]; }
+      const Index* m_lengths;
+    };
+
+    // Accumulates the NC columns of the rhs starting at x into acc for the chunk k
+    template<int NC>
+    EIGEN_STRONG_INLINE void chunk_product(Index k, const Scalar* x, Index xStride, Packet* acc) const
+    {
+      const Scalar* values = m_values.data() + m_chunkPtr(k);
+      const Index* indices = m_indices.data() + m_chunkPtr(k);
+      const Index size = m_chunkPtr(k+1) - m_chunkPtr(k);
+      for(int c=0; c<NC; ++c)
+        acc[c] = internal::pset1<Packet>(Scalar(0));
+      for(Index j=0; j<size; j+=ChunkSize)
+      {
+        const Packet a = internal::pload<Packet>(values+j);
+        for(int c=0; c<NC; ++c)
+          acc[c] = internal::pmadd(a, internal::pgather<Packet>(x+c*xStride, indices+j), acc[c]);
+      }
+    }
+
+    // Computes the chunks [first,last) of the product, by blocks of up to 4 columns of the rhs
+    template<typename Dest> struct product_range
+    {
+      void operator()(Index first, Index last) const
+      {
+        Packet acc[4];
+        EIGEN_ALIGN16 Scalar res[ChunkSize];
+        for(Index k=first; k<last; ++k)
+        {
+          for(Index c0=0; c0<rhsCols; c0+=4)
+          {
+            const Index nc = (std::min)(Index(4), rhsCols-c0);
+            const Scalar* x = rhs + c0*rhsStride;
+            switch(nc)
+            {
+              case 4:  mat->template chunk_product<4>(k, x, rhsStride, acc); break;
+              case 3:  mat->template chunk_product<3>(k, x, rhsStride, acc); break;
+              case 2:  mat->template chunk_product<2>(k, x, rhsStride, acc); break;
+              default: mat->template chunk_product<1>(k, x, rhsStride, acc); break;
+            }
+            for(Index c=0; c<nc; ++c)
+            {
+              internal::pstore(res, acc[c]);
+              for(Index l=0; l<ChunkSize; ++l)
+              {
+                const Index row = mat->m_perm(k*ChunkSize+l);
+                if(row>=0)
+                  dst->coeffRef(row, c0+c) += alpha * res[l];
+              }
+            }
+          }
+        }
+      }
+
+      const SlicedEllpackMatrix* mat;
+      const Scalar* rhs;
+      Index rhsStride, rhsCols;
+      Dest* dst;
+      Scalar alpha;
+    };
+
+    Index m_rows, m_cols, m_sigma, m_nonZeros;
+    Matrix<Index,Dynamic,1> m_perm;       // original row of each stored row
+    Matrix<Index,Dynamic,1> m_chunkPtr;   // start of each chunk in m_values and m_indices
+    Matrix<Scalar,Dynamic,1> m_values;    // the chunks, column-major
+    Matrix<Index,Dynamic,1> m_indices;    // the column index of each stored value
+};
+
+namespace internal {
+template<typename Lhs, typename Rhs>
+struct traits<SlicedEllpackProduct<Lhs,Rhs> >
+{
+  typedef Matrix<typename Lhs::Scalar,Dynamic,Rhs::ColsAtCompileTime> ReturnType;
+};
+
+/** \internal Sets [begin,end) to the addresses spanned by the coefficients of \a xpr, or to an empty
+  * range with begin==0 when \a xpr has no direct access. */
+template<typename Xpr, bool HasDirectAccess = (int(traits<Xpr>::Flags)&DirectAccessBit)!=0>
+struct dense_storage_range
+{
+  static void run(const Xpr&, const void*& begin, const void*& end) { begin = end = 0; }
+};
+
+template<typename Xpr>
+struct dense_storage_range<Xpr,true>
+{
+  static void run(const Xpr& xpr, const void*& begin, const void*& end)
+  {
+    const typename Xpr::Scalar* data = xpr.data();
+    begin = data;
+    end = xpr.size()==0 ? data : data + (xpr.rows()-1)*xpr.rowStride() + (xpr.cols()-1)*xpr.colStride() + 1;
+  }
+};
+
+/** \internal \returns whether writing into \a dst may overwrite coefficients of \a rhs, i.e. whether their
+  * storages overlap. Expressions without direct access are assumed to alias. */
+template<typename Rhs, typename Dest>
+bool dense_storage_may_alias(const Rhs& rhs, const Dest& dst)
+{
+  const void *rhsBegin, *rhsEnd, *dstBegin, *dstEnd;
+  dense_storage_range<Rhs>::run(rhs, rhsBegin, rhsEnd);
+  dense_storage_range<Dest>::run(dst, dstBegin, dstEnd);
+  if(rhsBegin==0 || dstBegin==0)
+    return true;
+  return std::less<const void*>()(rhsBegin, dstEnd) && std::less<const void*>()(dstBegin, rhsEnd);
+}
+}
+
+/** \ingroup SparseExtra_Module
+  *
+  * \brief Expression of the product of a SlicedEllpackMatrix by a dense matrix
+  *
+  * \sa SlicedEllpackMatrix::operator*()
+  */
+template<typename Lhs, typename Rhs>
+class SlicedEllpackProduct : public ReturnByValue<SlicedEllpackProduct<Lhs,Rhs> >
+{
+  public:
+    typedef typename Lhs::Scalar Scalar;
+    typedef typename Rhs::Index Index;
+
+    SlicedEllpackProduct(const Lhs& lhs, const Rhs& rhs) : m_lhs(lhs), m_rhs(rhs) {}
+
+    inline Index rows() const { return m_lhs.rows(); }
+    inline Index cols() const { return m_rhs.cols(); }
+
+    template<typename Dest> void evalTo(Dest& dst) const
+    {
+      // dst is cleared before the rhs is read, so x = A * x goes through a temporary
+      if(internal::dense_storage_may_alias(m_rhs, dst))
+      {
+        typename internal::traits<SlicedEllpackProduct>::ReturnType tmp(rows(), cols());
+        tmp.setZero();
+        m_lhs.addProductTo(m_rhs, tmp);
+        dst = tmp;
+        return;
+      }
+      dst.setZero();
+      m_lhs.addProductTo(m_rhs, dst);
+    }
+
+  protected:
+    const Lhs& m_lhs;
+    typename Rhs::Nested m_rhs;
+};
+
+} // end namespace Eigen
+
+#endif // EIGEN_SLICED_ELLPACK_MATRIX_H